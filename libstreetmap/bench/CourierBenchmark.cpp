@@ -0,0 +1,273 @@
+#include "CourierBenchmark.h"
+#include "RoutingOracle.h"
+#include "m1.h"
+#include "m3.h"
+#include "Store.h"
+#include "ReportUtil.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+static std::string getScenarioName(const CourierScenario& scenario) {
+    return std::to_string(scenario.deliveries) + "x" + std::to_string(scenario.depots)
+            + (scenario.layout == CLUSTERED_DELIVERIES ? "_clustered" : "_uniform")
+            + (scenario.tightCapacity ? "_tight" : "_loose");
+}
+
+// Intersection at the end of a random walk, the walk stops early at a dead end
+static unsigned randomWalk(unsigned start, unsigned hops, std::mt19937& random) {
+    unsigned current = start;
+    for (unsigned hop = 0; hop < hops; hop++) {
+        std::vector<unsigned> adjacent = find_adjacent_intersections(current);
+        if (adjacent.empty()) break;
+        current = adjacent[std::uniform_int_distribution<std::size_t>(0, adjacent.size() - 1)(random)];
+    }
+    return current;
+}
+
+// Travel time of a route, DBL_MAX if there is no route
+static double getRouteCost(const std::vector<CourierSubpath>& route, double rightTurnPenalty, double leftTurnPenalty) {
+    if (route.empty()) return DBL_MAX;
+
+    double cost = 0;
+    for (auto subpath = route.begin(); subpath != route.end(); subpath++) {
+        if (!subpath->subpath.empty()) cost += compute_path_travel_time(subpath->subpath, rightTurnPenalty, leftTurnPenalty);
+    }
+    return cost;
+}
+
+std::vector<CourierScenario> getDefaultCourierScenarios() {
+    const std::vector<std::pair<unsigned, unsigned>> sizes = {{10, 2}, {40, 5}, {100, 10}};
+
+    std::vector<CourierScenario> scenarios;
+    for (auto size = sizes.begin(); size != sizes.end(); size++) {
+        for (int layout = UNIFORM_DELIVERIES; layout <= CLUSTERED_DELIVERIES; layout++) {
+            for (int tight = 0; tight <= 1; tight++) {
+                CourierScenario scenario;
+                scenario.deliveries = size->first;
+                scenario.depots = size->second;
+                scenario.layout = (DeliveryLayout)layout;
+                scenario.tightCapacity = tight;
+                scenarios.push_back(scenario);
+            }
+        }
+    }
+
+    return scenarios;
+}
+
+CourierInstance generateCourierInstance(const CourierScenario& scenario, unsigned seed) {
+    CourierInstance instance;
+    instance.name = getScenarioName(scenario);
+    if (getNumIntersections() < 2) return instance;
+
+    // Seeded by the scenario as well, so each instance is the same whatever other scenarios are run
+    std::seed_seq sequence = {seed, scenario.deliveries, scenario.depots, (unsigned)scenario.layout, (unsigned)scenario.tightCapacity};
+    std::mt19937 random(sequence);
+    std::uniform_int_distribution<unsigned> intersection(0, getNumIntersections() - 1);
+    std::uniform_real_distribution<float> weight(1, MAX_COURIER_WEIGHT);
+
+    std::vector<unsigned> centers;
+    for (unsigned center = 0; center < CLUSTER_COUNT; center++) centers.push_back(intersection(random));
+
+    auto placeIntersection = [&]() {
+        if (scenario.layout == UNIFORM_DELIVERIES) return intersection(random);
+        unsigned center = centers[std::uniform_int_distribution<unsigned>(0, CLUSTER_COUNT - 1)(random)];
+        return randomWalk(center, CLUSTER_WALK_HOPS, random);
+    };
+
+    float totalWeight = 0, heaviest = 0;
+    while (instance.deliveries.size() < scenario.deliveries) {
+        unsigned pickUp = placeIntersection();
+        unsigned dropOff = placeIntersection();
+        if (pickUp == dropOff) continue;
+
+        float itemWeight = weight(random);
+        instance.deliveries.push_back(DeliveryInfo(pickUp, dropOff, itemWeight));
+        totalWeight += itemWeight;
+        heaviest = std::max(heaviest, itemWeight);
+    }
+
+    for (unsigned depot = 0; depot < scenario.depots; depot++) instance.depots.push_back(placeIntersection());
+
+    instance.truckCapacity = scenario.tightCapacity ? heaviest * TIGHT_CAPACITY_ITEMS : totalWeight;
+    return instance;
+}
+
+std::string getCourierRouteError(const CourierInstance& instance, const std::vector<CourierSubpath>& route) {
+    if (route.empty()) return "no route";
+
+    std::vector<bool> pickedUp(instance.deliveries.size(), false);
+    std::vector<bool> droppedOff(instance.deliveries.size(), false);
+    float load = 0;
+
+    // Drops off every carried delivery bound for the intersection
+    auto dropOff = [&](unsigned intersection) {
+        for (unsigned delivery = 0; delivery < instance.deliveries.size(); delivery++) {
+            if (pickedUp[delivery] && !droppedOff[delivery] && instance.deliveries[delivery].dropOff == intersection) {
+                droppedOff[delivery] = true;
+                load -= instance.deliveries[delivery].itemWeight;
+            }
+        }
+    };
+
+    if (std::find(instance.depots.begin(), instance.depots.end(), route.front().start_intersection) == instance.depots.end()) return "route does not start at a depot";
+    if (std::find(instance.depots.begin(), instance.depots.end(), route.back().end_intersection) == instance.depots.end()) return "route does not end at a depot";
+
+    for (unsigned index = 0; index < route.size(); index++) {
+        const CourierSubpath& subpath = route[index];
+        std::string prefix = "subpath " + std::to_string(index) + ": ";
+
+        if (index > 0 && subpath.start_intersection != route[index - 1].end_intersection) return prefix + "does not start where the previous subpath ended";
+
+        std::string pathError = getPathError(subpath.subpath, subpath.start_intersection, subpath.end_intersection);
+        if (!pathError.empty()) return prefix + pathError;
+
+        dropOff(subpath.start_intersection);
+        for (auto delivery = subpath.pickUp_indices.begin(); delivery != subpath.pickUp_indices.end(); delivery++) {
+            if (*delivery >= instance.deliveries.size()) return prefix + "picks up a delivery that does not exist";
+            if (pickedUp[*delivery]) return prefix + "picks up delivery " + std::to_string(*delivery) + " twice";
+            if (instance.deliveries[*delivery].pickUp != subpath.start_intersection) return prefix + "picks up delivery " + std::to_string(*delivery) + " away from its pickup";
+
+            pickedUp[*delivery] = true;
+            load += instance.deliveries[*delivery].itemWeight;
+        }
+        dropOff(subpath.start_intersection);
+
+        // Float weights are summed in a different order than the solver summed them
+        if (load > instance.truckCapacity * (1 + 1e-5f)) return prefix + "leaves over capacity";
+    }
+
+    for (unsigned delivery = 0; delivery < instance.deliveries.size(); delivery++) {
+        if (!droppedOff[delivery]) return "delivery " + std::to_string(delivery) + " is never dropped off";
+    }
+
+    return "";
+}
+
+CourierBenchmark::CourierBenchmark(unsigned benchmarkSeed, double right, double left) {
+    seed = benchmarkSeed;
+    rightTurnPenalty = right;
+    leftTurnPenalty = left;
+}
+
+bool CourierBenchmark::loadBestKnown(std::string path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string map, instance;
+    double cost;
+    while (file >> map >> instance >> cost) bestKnown[map + " " + instance] = cost;
+
+    return true;
+}
+
+bool CourierBenchmark::saveBestKnown(std::string path) {
+    std::map<std::string, double> costs = bestKnown;
+    for (auto result = results.begin(); result != results.end(); result++) {
+        if (!result->error.empty()) continue;
+
+        std::string key = result->map + " " + result->instance.name;
+        auto best = costs.find(key);
+        if (best == costs.end() || result->cost < best->second) costs[key] = result->cost;
+    }
+
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file << std::setprecision(10);
+    for (auto cost = costs.begin(); cost != costs.end(); cost++) file << cost->first << " " << cost->second << "\n";
+
+    return (bool)file;
+}
+
+void CourierBenchmark::runMap(std::string mapName, const std::vector<CourierScenario>& scenarios) {
+    for (auto scenario = scenarios.begin(); scenario != scenarios.end(); scenario++) {
+        CourierResult result;
+        result.map = mapName;
+        result.instance = generateCourierInstance(*scenario, seed);
+
+        std::vector<CourierSubpath> route = traveling_courier(result.instance.deliveries, result.instance.depots,
+                rightTurnPenalty, leftTurnPenalty, result.instance.truckCapacity);
+
+        CourierTrace& trace = store.courierTrace;
+        result.matrixTime = trace.getMatrixTime();
+        result.solveTime = trace.getSolveTime();
+        result.totalTime = trace.getTotalTime();
+        result.improvements = trace.getImprovements();
+        result.cost = getRouteCost(route, rightTurnPenalty, leftTurnPenalty);
+        result.error = getCourierRouteError(result.instance, route);
+
+        auto best = bestKnown.find(mapName + " " + result.instance.name);
+        if (best != bestKnown.end()) result.bestKnownCost = best->second;
+
+        results.push_back(result);
+    }
+}
+
+std::vector<CourierResult> CourierBenchmark::getResults() {
+    return results;
+}
+
+// Builds a table with one row per instance, the gap is to the best known cost
+std::string CourierBenchmark::getSummary() {
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(1);
+    summary << std::left << std::setw(28) << "map" << std::setw(24) << "instance" << std::right
+            << std::setw(12) << "cost s" << std::setw(10) << "gap %" << std::setw(12) << "matrix ms" << std::setw(12) << "solve ms"
+            << std::setw(14) << "improvements" << "  error\n";
+
+    for (auto result = results.begin(); result != results.end(); result++) {
+        summary << std::left << std::setw(28) << result->map << std::setw(24) << result->instance.name << std::right;
+
+        if (result->error.empty()) summary << std::setw(12) << result->cost; else summary << std::setw(12) << "-";
+        if (result->error.empty() && result->bestKnownCost > 0) {
+            summary << std::setw(10) << 100 * (result->cost - result->bestKnownCost) / result->bestKnownCost;
+        } else {
+            summary << std::setw(10) << "-";
+        }
+
+        summary << std::setw(12) << result->matrixTime << std::setw(12) << result->solveTime
+                << std::setw(14) << result->improvements.size() << "  " << result->error << "\n";
+    }
+
+    return summary.str();
+}
+
+bool CourierBenchmark::writeJSON(std::string path) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file << "{\n  \"seed\": " << seed << ",\n  \"right_turn_penalty\": " << rightTurnPenalty
+         << ",\n  \"left_turn_penalty\": " << leftTurnPenalty << ",\n";
+
+    file << "  \"results\": [";
+    for (auto result = results.begin(); result != results.end(); result++) {
+        bool valid = result->error.empty();
+
+        file << (result == results.begin() ? "\n" : ",\n");
+        file << "    {\"map\": " << quoteJSON(result->map) << ", \"instance\": " << quoteJSON(result->instance.name)
+             << ", \"deliveries\": " << result->instance.deliveries.size() << ", \"depots\": " << result->instance.depots.size()
+             << ", \"truck_capacity\": " << result->instance.truckCapacity
+             << ", \"matrix_ms\": " << result->matrixTime << ", \"solve_ms\": " << result->solveTime << ", \"total_ms\": " << result->totalTime
+             << ", \"valid\": " << (valid ? "true" : "false") << ", \"error\": " << quoteJSON(result->error) << ", \"cost\": ";
+        if (valid) file << result->cost; else file << "null";
+        file << ", \"best_known_cost\": ";
+        if (result->bestKnownCost > 0) file << result->bestKnownCost; else file << "null";
+
+        file << ", \"improvements\": [";
+        for (auto improvement = result->improvements.begin(); improvement != result->improvements.end(); improvement++) {
+            file << (improvement == result->improvements.begin() ? "" : ", ");
+            file << "{\"ms\": " << improvement->time << ", \"cost\": " << improvement->cost << "}";
+        }
+        file << "]}";
+    }
+    file << "\n  ]\n}\n";
+
+    return true;
+}
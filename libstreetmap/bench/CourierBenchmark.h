@@ -0,0 +1,107 @@
+/* Courier benchmark, runs traveling_courier on generated instances and records how its cost improves over time
+ * Instances vary in size, in how the pickups and drop offs are spread (uniformly or around a few clusters) and
+ * in truck capacity (tight enough to force several trips, or loose enough to never fill the truck). The same
+ * seed always generates the same instances, so results can be compared to the best known cost of each instance
+ * Each run is split into the matrix phase and the solve phase, see CourierTrace
+ */
+
+#ifndef COURIERBENCHMARK_H
+#define COURIERBENCHMARK_H
+
+#include "m4.h"
+#include "CourierTrace.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Clustered instances place every intersection a random walk of CLUSTER_WALK_HOPS from one of CLUSTER_COUNT centers
+#define CLUSTER_COUNT 3
+#define CLUSTER_WALK_HOPS 15
+
+// A tight truck holds TIGHT_CAPACITY_ITEMS of the heaviest items
+#define TIGHT_CAPACITY_ITEMS 3
+
+// Heaviest random delivery, a delivery weighs between 1 and this
+#define MAX_COURIER_WEIGHT 10
+
+enum DeliveryLayout {
+    UNIFORM_DELIVERIES = 0,
+    CLUSTERED_DELIVERIES
+};
+
+struct CourierScenario {
+    unsigned deliveries = 10;
+    unsigned depots = 2;
+    DeliveryLayout layout = UNIFORM_DELIVERIES;
+    bool tightCapacity = false;
+};
+
+struct CourierInstance {
+    std::string name;
+    std::vector<DeliveryInfo> deliveries;
+    std::vector<unsigned> depots;
+    float truckCapacity = 0;
+};
+
+struct CourierResult {
+    std::string map;
+    CourierInstance instance;
+
+    // ms, see CourierTrace
+    double matrixTime = 0;
+    double solveTime = 0;
+    double totalTime = 0;
+
+    // Travel time of the returned route, recomputed from its subpaths, DBL_MAX if there is no route
+    double cost = 0;
+    std::string error;
+    std::vector<CourierImprovement> improvements;
+
+    // Best cost known before this run, 0 if none is known
+    double bestKnownCost = 0;
+};
+
+class CourierBenchmark {
+public:
+    CourierBenchmark(unsigned benchmarkSeed, double right, double left);
+
+    // Best known costs, one "<map> <instance> <cost>" line per instance, returns false if the file could not be read
+    bool loadBestKnown(std::string path);
+
+    // Writes the best known costs, improved by the valid routes found so far
+    bool saveBestKnown(std::string path);
+
+    // Runs every scenario on the loaded map
+    void runMap(std::string mapName, const std::vector<CourierScenario>& scenarios);
+
+    // Getters
+    std::vector<CourierResult> getResults();
+    std::string getSummary();
+
+    // Writes every result with its improvement curve as a JSON object, returns false if the file could not be opened
+    bool writeJSON(std::string path);
+
+private:
+    unsigned seed;
+    double rightTurnPenalty;
+    double leftTurnPenalty;
+
+    std::map<std::string, double> bestKnown;
+    std::vector<CourierResult> results;
+};
+
+// Every size with both layouts and both capacities
+std::vector<CourierScenario> getDefaultCourierScenarios();
+
+// Instance of a scenario on the loaded map, named after the scenario
+CourierInstance generateCourierInstance(const CourierScenario& scenario, unsigned seed);
+
+/* Checks a courier route against its instance: subpaths legal and chained from a depot back to a depot,
+ * every delivery picked up once and dropped off after, and the truck never over capacity
+ * @params instance, route
+ * @returns an empty string if the route is valid, otherwise why it is not
+ */
+std::string getCourierRouteError(const CourierInstance& instance, const std::vector<CourierSubpath>& route);
+
+#endif /* COURIERBENCHMARK_H */
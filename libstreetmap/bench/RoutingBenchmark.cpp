@@ -0,0 +1,494 @@
+#include "RoutingBenchmark.h"
+#include "m1.h"
+#include "m3.h"
+#include "m4.h"
+#include "util.h"
+#include "Store.h"
+#include "TurnGraph.h"
+#include "CellOverlay.h"
+#include "BatchRouting.h"
+#include "RouteCache.h"
+#include "Isochrone.h"
+#include "FacilityIndex.h"
+#include "ReportUtil.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <queue>
+#include <random>
+#include <sstream>
+
+// Query sets are seeded apart from each other, so adding a query set never changes the queries of another
+#define RANDOM_SEED_OFFSET 0
+#define LOCAL_SEED_OFFSET 1
+#define LONG_HAUL_SEED_OFFSET 2
+#define RANK_SEED_OFFSET 3
+#define MULTI_SEED_OFFSET 4
+#define COURIER_SEED_OFFSET 5
+
+// Heaviest random delivery, a delivery weighs between 1 and this
+#define MAX_DELIVERY_WEIGHT 10
+
+// Penalty pairs the cell overlay is customized for, right then left
+static const std::vector<std::pair<double, double>> CUSTOMIZATION_PENALTIES = {{0, 0}, {7, 13}, {15, 25}, {30, 60}};
+
+// Difference of the search counters over a workload
+static SearchStats subtractStats(const SearchStats& after, const SearchStats& before) {
+    SearchStats stats;
+    stats.searches = after.searches - before.searches;
+    stats.settledNodes = after.settledNodes - before.settledNodes;
+    stats.heapPushes = after.heapPushes - before.heapPushes;
+    stats.heapPops = after.heapPops - before.heapPops;
+    return stats;
+}
+
+static unsigned randomIntersection(std::mt19937& random) {
+    return std::uniform_int_distribution<unsigned>(0, getNumIntersections() - 1)(random);
+}
+
+/* Intersections in the order a Dijkstra on travel time without turn penalties settles them
+ * @params source
+ * @returns every intersection reachable from source, source first
+ */
+static std::vector<unsigned> getSettleOrder(unsigned source) {
+    typedef std::pair<double, unsigned> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    std::vector<double> bestTimes(getNumIntersections(), -1);
+    std::vector<bool> settled(getNumIntersections(), false);
+    std::vector<unsigned> order;
+
+    bestTimes[source] = 0;
+    queue.push(std::make_pair(0, source));
+
+    while (!queue.empty()) {
+        QueueEntry entry = queue.top();
+        queue.pop();
+        if (settled[entry.second]) continue;
+
+        settled[entry.second] = true;
+        order.push_back(entry.second);
+
+        const std::vector<unsigned>& segments = store.SEGMENTS_IDS[entry.second];
+        for (auto segment = segments.begin(); segment != segments.end(); segment++) {
+            InfoStreetSegment info = getInfoStreetSegment(*segment);
+            if ((unsigned)info.from != entry.second && info.oneWay) continue;
+
+            unsigned next = (unsigned)info.from == entry.second ? info.to : info.from;
+            double time = entry.first + store.SEGMENTS[*segment]->getTravelTime();
+            if (!settled[next] && (bestTimes[next] < 0 || time < bestTimes[next])) {
+                bestTimes[next] = time;
+                queue.push(std::make_pair(time, next));
+            }
+        }
+    }
+
+    return order;
+}
+
+std::vector<RouteQuery> generateRandomQueries(unsigned count, unsigned seed) {
+    std::vector<RouteQuery> queries;
+    if (getNumIntersections() < 2) return queries;
+
+    std::mt19937 random(seed + RANDOM_SEED_OFFSET);
+    while (queries.size() < count) {
+        RouteQuery query;
+        query.from = randomIntersection(random);
+        query.to = randomIntersection(random);
+        if (query.from != query.to) queries.push_back(query);
+    }
+
+    return queries;
+}
+
+std::vector<RouteQuery> generateLocalQueries(unsigned count, unsigned seed) {
+    std::vector<RouteQuery> queries;
+    if (getNumIntersections() < 2) return queries;
+
+    // A walk can end where it started, so the number of attempts is bounded
+    std::mt19937 random(seed + LOCAL_SEED_OFFSET);
+    for (unsigned attempt = 0; attempt < 10 * count && queries.size() < count; attempt++) {
+        RouteQuery query;
+        query.from = randomIntersection(random);
+        query.to = query.from;
+
+        for (unsigned hop = 0; hop < LOCAL_QUERY_HOPS; hop++) {
+            std::vector<unsigned> adjacent = find_adjacent_intersections(query.to);
+            if (adjacent.empty()) break;
+            query.to = adjacent[std::uniform_int_distribution<std::size_t>(0, adjacent.size() - 1)(random)];
+        }
+
+        if (query.from != query.to) queries.push_back(query);
+    }
+
+    return queries;
+}
+
+std::vector<RouteQuery> generateLongHaulQueries(unsigned count, unsigned seed) {
+    std::vector<RouteQuery> queries;
+    if (getNumIntersections() < 2) return queries;
+
+    std::mt19937 random(seed + LONG_HAUL_SEED_OFFSET);
+    while (queries.size() < count) {
+        RouteQuery query;
+        query.from = randomIntersection(random);
+        query.to = query.from;
+
+        LatLon fromPosition = getIntersectionPosition(query.from);
+        double farthest = -1;
+        for (unsigned candidate = 0; candidate < LONG_HAUL_CANDIDATES; candidate++) {
+            unsigned to = randomIntersection(random);
+            double distance = find_distance_between_two_points(fromPosition, getIntersectionPosition(to));
+            if (to != query.from && distance > farthest) {
+                farthest = distance;
+                query.to = to;
+            }
+        }
+
+        if (query.from != query.to) queries.push_back(query);
+    }
+
+    return queries;
+}
+
+std::vector<std::vector<RouteQuery>> generateRankQueries(unsigned count, unsigned seed) {
+    std::vector<std::vector<RouteQuery>> rankQueries;
+    if (getNumIntersections() < 2) return rankQueries;
+
+    // Highest rank with an intersection at 2^rank
+    unsigned maxRank = (unsigned)std::log2(getNumIntersections() - 1);
+    if (maxRank < MIN_QUERY_RANK) return rankQueries;
+    rankQueries.resize(maxRank - MIN_QUERY_RANK + 1);
+
+    unsigned sources = std::max(1u, count / (unsigned)rankQueries.size());
+    std::mt19937 random(seed + RANK_SEED_OFFSET);
+
+    for (unsigned source = 0; source < sources; source++) {
+        RouteQuery query;
+        query.from = randomIntersection(random);
+        std::vector<unsigned> order = getSettleOrder(query.from);
+
+        for (unsigned rank = MIN_QUERY_RANK; rank <= maxRank; rank++) {
+            std::size_t position = (std::size_t)1 << rank;
+            if (position >= order.size()) break;
+
+            query.to = order[position];
+            rankQueries[rank - MIN_QUERY_RANK].push_back(query);
+        }
+    }
+
+    return rankQueries;
+}
+
+double WorkloadResult::getPercentile(double p) const {
+    if (latencies.empty()) return 0;
+
+    std::size_t rank = (std::size_t)std::ceil(p / 100 * latencies.size());
+    return latencies[std::min(latencies.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+double WorkloadResult::getQueriesPerSecond() const {
+    return wallTime > 0 ? latencies.size() / (wallTime / 1000) : 0;
+}
+
+RoutingBenchmark::RoutingBenchmark(BenchmarkOptions benchmarkOptions) {
+    options = benchmarkOptions;
+}
+
+void RoutingBenchmark::runPathQueries(std::string mapName, std::string workload, std::string function, const RoutingEngine& engine,
+        const std::vector<RouteQuery>& queries) {
+    WorkloadResult result;
+    result.map = mapName;
+    result.workload = workload;
+    result.function = function;
+
+    SearchStats before = getSearchStats();
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto query = queries.begin(); query != queries.end(); query++) {
+        auto queryStart = std::chrono::steady_clock::now();
+        std::vector<unsigned> path = engine(query->from, query->to, options.rightTurnPenalty, options.leftTurnPenalty);
+        result.latencies.push_back(elapsedMilliseconds(queryStart));
+
+        if (path.empty()) result.unreachable++;
+    }
+
+    result.wallTime = elapsedMilliseconds(start);
+    result.stats = subtractStats(getSearchStats(), before);
+    std::sort(result.latencies.begin(), result.latencies.end());
+    results.push_back(result);
+}
+
+// The whole query set is one batch, so calls/s is the throughput of all workers together
+void RoutingBenchmark::runBatchQueries(std::string mapName, std::string workload, const std::vector<RouteQuery>& queries) {
+    WorkloadResult result;
+    result.map = mapName;
+    result.workload = workload;
+    result.function = "findPathsInBatch";
+
+    std::vector<RouteRequest> requests;
+    for (auto query = queries.begin(); query != queries.end(); query++) {
+        requests.push_back(RouteRequest{query->from, query->to, options.rightTurnPenalty, options.leftTurnPenalty});
+    }
+
+    SearchStats before = getSearchStats();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<RouteResult> routes = findPathsInBatch(requests);
+    result.wallTime = elapsedMilliseconds(start);
+    result.stats = subtractStats(getSearchStats(), before);
+
+    for (auto route = routes.begin(); route != routes.end(); route++) {
+        result.latencies.push_back(route->searchTime);
+        if (route->path.empty()) result.unreachable++;
+    }
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    results.push_back(result);
+}
+
+void RoutingBenchmark::runMultiQueries(std::string mapName, unsigned seed) {
+    WorkloadResult result;
+    result.map = mapName;
+    result.workload = "random";
+    result.function = "find_paths_to_destinations";
+    if (getNumIntersections() < 2) return;
+
+    std::mt19937 random(seed + MULTI_SEED_OFFSET);
+    std::vector<std::pair<unsigned, std::unordered_set<unsigned>>> queries;
+    for (unsigned query = 0; query < options.multiQueries; query++) {
+        unsigned source = randomIntersection(random);
+        std::unordered_set<unsigned> destinations;
+        for (unsigned destination = 0; destination < options.destinationCount; destination++) {
+            destinations.insert(randomIntersection(random));
+        }
+        queries.push_back(std::make_pair(source, destinations));
+    }
+
+    SearchStats before = getSearchStats();
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto query = queries.begin(); query != queries.end(); query++) {
+        auto queryStart = std::chrono::steady_clock::now();
+        std::unordered_map<unsigned, std::pair<double, std::vector<unsigned>>> paths = find_paths_to_destinations(query->first, query->second, options.rightTurnPenalty, options.leftTurnPenalty);
+        result.latencies.push_back(elapsedMilliseconds(queryStart));
+
+        // A destination other than the source without a path was not reached
+        for (auto destination = query->second.begin(); destination != query->second.end(); destination++) {
+            auto path = paths.find(*destination);
+            if (*destination != query->first && (path == paths.end() || path->second.second.empty())) result.unreachable++;
+        }
+    }
+
+    result.wallTime = elapsedMilliseconds(start);
+    result.stats = subtractStats(getSearchStats(), before);
+    std::sort(result.latencies.begin(), result.latencies.end());
+    results.push_back(result);
+}
+
+// One to all sweeps from the sources of the queries, a sweep that reaches no other intersection counts as unreachable
+void RoutingBenchmark::runSweeps(std::string mapName, const std::vector<RouteQuery>& queries) {
+    WorkloadResult result;
+    result.map = mapName;
+    result.workload = "one_to_all";
+    result.function = "findTravelTimesFrom";
+
+    SearchStats before = getSearchStats();
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned query = 0; query < queries.size() && query < options.multiQueries; query++) {
+        auto queryStart = std::chrono::steady_clock::now();
+        std::vector<double> times = findTravelTimesFrom(queries[query].from, options.rightTurnPenalty, options.leftTurnPenalty);
+        result.latencies.push_back(elapsedMilliseconds(queryStart));
+
+        if (std::count(times.begin(), times.end(), DBL_MAX) + 1 == (long)times.size()) result.unreachable++;
+    }
+
+    result.wallTime = elapsedMilliseconds(start);
+    result.stats = subtractStats(getSearchStats(), before);
+    std::sort(result.latencies.begin(), result.latencies.end());
+    results.push_back(result);
+}
+
+// Closest POIs of each type in turn, a search that finds fewer than FACILITY_DEFAULT_RESULTS counts as unreachable
+void RoutingBenchmark::runNearestQueries(std::string mapName, const std::vector<RouteQuery>& queries) {
+    WorkloadResult result;
+    result.map = mapName;
+    result.workload = "random";
+    result.function = "findNearestFacilities";
+    if (store.facilityIndex.getCategoryCount() == 0) return;
+
+    SearchStats before = getSearchStats();
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned query = 0; query < queries.size() && query < options.multiQueries; query++) {
+        std::string type = store.facilityIndex.getCategoryName(query % store.facilityIndex.getCategoryCount());
+
+        auto queryStart = std::chrono::steady_clock::now();
+        std::vector<FacilityMatch> matches = findNearestFacilities(queries[query].from, type, FACILITY_DEFAULT_RESULTS, options.rightTurnPenalty, options.leftTurnPenalty);
+        result.latencies.push_back(elapsedMilliseconds(queryStart));
+
+        if (matches.size() < FACILITY_DEFAULT_RESULTS) result.unreachable++;
+    }
+
+    result.wallTime = elapsedMilliseconds(start);
+    result.stats = subtractStats(getSearchStats(), before);
+    std::sort(result.latencies.begin(), result.latencies.end());
+    results.push_back(result);
+}
+
+void RoutingBenchmark::runCourierQueries(std::string mapName, unsigned seed) {
+    WorkloadResult result;
+    result.map = mapName;
+    result.workload = "random";
+    result.function = "traveling_courier";
+    if (getNumIntersections() < 2) return;
+
+    std::mt19937 random(seed + COURIER_SEED_OFFSET);
+    std::uniform_real_distribution<float> weight(1, MAX_DELIVERY_WEIGHT);
+
+    std::vector<std::pair<std::vector<DeliveryInfo>, std::vector<unsigned>>> instances;
+    for (unsigned instance = 0; instance < options.courierInstances; instance++) {
+        std::vector<DeliveryInfo> deliveries;
+        std::vector<unsigned> depots;
+
+        for (unsigned delivery = 0; delivery < options.courierDeliveries; delivery++) {
+            deliveries.push_back(DeliveryInfo(randomIntersection(random), randomIntersection(random), weight(random)));
+        }
+        for (unsigned depot = 0; depot < options.courierDepots; depot++) {
+            depots.push_back(randomIntersection(random));
+        }
+        instances.push_back(std::make_pair(deliveries, depots));
+    }
+
+    SearchStats before = getSearchStats();
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto instance = instances.begin(); instance != instances.end(); instance++) {
+        auto queryStart = std::chrono::steady_clock::now();
+        std::vector<CourierSubpath> route = traveling_courier(instance->first, instance->second, options.rightTurnPenalty, options.leftTurnPenalty, options.truckCapacity);
+        result.latencies.push_back(elapsedMilliseconds(queryStart));
+
+        if (route.empty()) result.unreachable++;
+    }
+
+    result.wallTime = elapsedMilliseconds(start);
+    result.stats = subtractStats(getSearchStats(), before);
+    std::sort(result.latencies.begin(), result.latencies.end());
+    results.push_back(result);
+}
+
+void RoutingBenchmark::runMap(std::string mapName) {
+    // Every map gets the same queries for the same seed
+    unsigned seed = options.seed;
+
+    std::vector<std::pair<std::string, std::vector<RouteQuery>>> querySets;
+    querySets.push_back(std::make_pair("random", generateRandomQueries(options.queries, seed)));
+    querySets.push_back(std::make_pair("local", generateLocalQueries(options.queries, seed)));
+    querySets.push_back(std::make_pair("long_haul", generateLongHaulQueries(options.queries, seed)));
+
+    std::vector<std::vector<RouteQuery>> rankQueries = generateRankQueries(options.queries, seed);
+    for (unsigned rank = 0; rank < rankQueries.size(); rank++) {
+        if (!rankQueries[rank].empty()) querySets.push_back(std::make_pair("rank_" + std::to_string(rank + MIN_QUERY_RANK), rankQueries[rank]));
+    }
+
+    const std::vector<std::pair<std::string, RoutingEngine>> engines = {
+        {"find_path_between_intersections", find_path_between_intersections},
+        {"findTurnExactPath", findTurnExactPath},
+        {"findOverlayPath", findOverlayPath}
+    };
+
+    for (auto querySet = querySets.begin(); querySet != querySets.end(); querySet++) {
+        for (auto engine = engines.begin(); engine != engines.end(); engine++) {
+            runPathQueries(mapName, querySet->first, engine->first, engine->second, querySet->second);
+        }
+    }
+
+    runBatchQueries(mapName, querySets.front().first, querySets.front().second);
+
+    // Every query is sent twice, the second round is served by the route cache
+    std::vector<RouteQuery> repeated = querySets.front().second;
+    repeated.insert(repeated.end(), querySets.front().second.begin(), querySets.front().second.end());
+    auto cachedPath = [](unsigned from, unsigned to, double right, double left) { return findCachedPath(from, to, right, left); };
+    runPathQueries(mapName, "repeated", "findCachedPath", cachedPath, repeated);
+    runMultiQueries(mapName, seed);
+    runSweeps(mapName, querySets.front().second);
+    runNearestQueries(mapName, querySets.front().second);
+    runCourierQueries(mapName, seed);
+    runCustomizations(mapName);
+}
+
+// Customizes every penalty pair past the overlay metric cache, the latency of a call is the time until its metric is ready
+void RoutingBenchmark::runCustomizations(std::string mapName) {
+    WorkloadResult result;
+    result.map = mapName;
+    result.workload = "penalties";
+    result.function = "CellOverlay::customize";
+
+    SearchStats before = getSearchStats();
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto penalties = CUSTOMIZATION_PENALTIES.begin(); penalties != CUSTOMIZATION_PENALTIES.end(); penalties++) {
+        OverlayMetric metric = store.cellOverlay.customize(penalties->first, penalties->second);
+        result.latencies.push_back(metric.customizationTime);
+    }
+
+    result.wallTime = elapsedMilliseconds(start);
+    result.stats = subtractStats(getSearchStats(), before);
+    std::sort(result.latencies.begin(), result.latencies.end());
+    results.push_back(result);
+}
+
+std::vector<WorkloadResult> RoutingBenchmark::getResults() {
+    return results;
+}
+
+// Builds a table with one row per workload, search work is per call
+std::string RoutingBenchmark::getSummary() {
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(2);
+    summary << std::left << std::setw(28) << "map" << std::setw(12) << "workload" << std::setw(34) << "function" << std::right
+            << std::setw(7) << "calls" << std::setw(11) << "p50 ms" << std::setw(11) << "p95 ms" << std::setw(11) << "p99 ms"
+            << std::setw(11) << "calls/s" << std::setw(12) << "settled" << std::setw(12) << "heap ops" << std::setw(13) << "unreachable" << "\n";
+
+    for (auto result = results.begin(); result != results.end(); result++) {
+        double calls = std::max<std::size_t>(result->latencies.size(), 1);
+
+        summary << std::left << std::setw(28) << result->map << std::setw(12) << result->workload << std::setw(34) << result->function << std::right
+                << std::setw(7) << result->latencies.size() << std::setw(11) << result->getPercentile(50)
+                << std::setw(11) << result->getPercentile(95) << std::setw(11) << result->getPercentile(99)
+                << std::setw(11) << result->getQueriesPerSecond() << std::setw(12) << (std::size_t)(result->stats.settledNodes / calls)
+                << std::setw(12) << (std::size_t)((result->stats.heapPushes + result->stats.heapPops) / calls)
+                << std::setw(13) << result->unreachable << "\n";
+    }
+
+    return summary.str();
+}
+
+bool RoutingBenchmark::writeJSON(std::string path) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file << "{\n  \"options\": {\"seed\": " << options.seed << ", \"queries\": " << options.queries
+         << ", \"multi_queries\": " << options.multiQueries << ", \"destination_count\": " << options.destinationCount
+         << ", \"courier_instances\": " << options.courierInstances << ", \"courier_deliveries\": " << options.courierDeliveries
+         << ", \"courier_depots\": " << options.courierDepots << ", \"truck_capacity\": " << options.truckCapacity
+         << ", \"right_turn_penalty\": " << options.rightTurnPenalty << ", \"left_turn_penalty\": " << options.leftTurnPenalty << "},\n";
+
+    file << "  \"results\": [";
+    for (auto result = results.begin(); result != results.end(); result++) {
+        file << (result == results.begin() ? "\n" : ",\n");
+        file << "    {\"map\": " << quoteJSON(result->map) << ", \"workload\": " << quoteJSON(result->workload)
+             << ", \"function\": " << quoteJSON(result->function) << ", \"calls\": " << result->latencies.size()
+             << ", \"unreachable\": " << result->unreachable << ", \"wall_ms\": " << result->wallTime
+             << ", \"p50_ms\": " << result->getPercentile(50) << ", \"p95_ms\": " << result->getPercentile(95)
+             << ", \"p99_ms\": " << result->getPercentile(99) << ", \"calls_per_s\": " << result->getQueriesPerSecond()
+             << ", \"searches\": " << result->stats.searches << ", \"settled_nodes\": " << result->stats.settledNodes
+             << ", \"heap_pushes\": " << result->stats.heapPushes << ", \"heap_pops\": " << result->stats.heapPops << "}";
+    }
+    file << "\n  ]\n}\n";
+
+    return true;
+}
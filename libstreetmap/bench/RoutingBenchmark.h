@@ -0,0 +1,113 @@
+/* Routing benchmark, runs reproducible query workloads against the loaded map and reports latency percentiles
+ * Query sets are generated from a seed, so two runs on the same map send exactly the same queries:
+ *   random     source and destination uniformly at random
+ *   local      destination a short random walk away from the source
+ *   long_haul  destination the farthest of several random candidates
+ *   rank_<r>   destination the 2^r-th intersection settled by a plain Dijkstra from the source
+ * Each workload records the latency of every call and the search work counted by SearchStats
+ * Point to point query sets are run on every path search backend, so backends are compared on the same queries
+ * The random query set is also run as one batch on every worker thread, and twice through the route cache
+ * The sources of the first multiQueries random queries are swept to every intersection by findTravelTimesFrom,
+ * and searched for the closest POIs of each type in turn by findNearestFacilities
+ * The cell overlay is also customized for a few penalty pairs, one call per pair
+ */
+
+#ifndef ROUTINGBENCHMARK_H
+#define ROUTINGBENCHMARK_H
+
+#include "SearchStats.h"
+#include "RoutingOracle.h"
+
+#include <string>
+#include <vector>
+
+// Steps of the random walk that picks a local destination
+#define LOCAL_QUERY_HOPS 8
+
+// Random candidates the farthest long haul destination is picked from
+#define LONG_HAUL_CANDIDATES 16
+
+// Smallest Dijkstra rank is 2^MIN_QUERY_RANK
+#define MIN_QUERY_RANK 4
+
+struct BenchmarkOptions {
+    unsigned seed = 297;
+
+    // Queries in each point to point query set
+    unsigned queries = 200;
+
+    // find_paths_to_destinations calls, each to destinationCount random destinations
+    unsigned multiQueries = 20;
+    unsigned destinationCount = 10;
+
+    // traveling_courier instances of courierDeliveries random deliveries from courierDepots depots
+    unsigned courierInstances = 5;
+    unsigned courierDeliveries = 20;
+    unsigned courierDepots = 3;
+    float truckCapacity = 50;
+
+    double rightTurnPenalty = 7;
+    double leftTurnPenalty = 13;
+};
+
+struct RouteQuery {
+    unsigned from;
+    unsigned to;
+};
+
+struct WorkloadResult {
+    std::string map;
+    std::string workload;
+    std::string function;
+
+    // Latency of each call in ms, sorted
+    std::vector<double> latencies;
+    double wallTime = 0;
+    unsigned unreachable = 0;
+    SearchStats stats;
+
+    // Nearest rank percentile of the latencies, p between 0 and 100
+    double getPercentile(double p) const;
+    double getQueriesPerSecond() const;
+};
+
+class RoutingBenchmark {
+public:
+    RoutingBenchmark(BenchmarkOptions benchmarkOptions);
+
+    // Runs every workload on the loaded map, results are added to the results of the maps run before
+    void runMap(std::string mapName);
+
+    // Getters
+    std::vector<WorkloadResult> getResults();
+    std::string getSummary();
+
+    // Writes the options and every result as a JSON object, returns false if the file could not be opened
+    bool writeJSON(std::string path);
+
+private:
+    BenchmarkOptions options;
+    std::vector<WorkloadResult> results;
+
+    void runPathQueries(std::string mapName, std::string workload, std::string function, const RoutingEngine& engine,
+            const std::vector<RouteQuery>& queries);
+    void runBatchQueries(std::string mapName, std::string workload, const std::vector<RouteQuery>& queries);
+    void runMultiQueries(std::string mapName, unsigned seed);
+    void runSweeps(std::string mapName, const std::vector<RouteQuery>& queries);
+    void runNearestQueries(std::string mapName, const std::vector<RouteQuery>& queries);
+    void runCourierQueries(std::string mapName, unsigned seed);
+    void runCustomizations(std::string mapName);
+};
+
+/* Query sets on the loaded map, queries never start and end at the same intersection
+ * @params count, seed
+ * @returns at most count queries, fewer if the map is too small for the query set
+ */
+std::vector<RouteQuery> generateRandomQueries(unsigned count, unsigned seed);
+std::vector<RouteQuery> generateLocalQueries(unsigned count, unsigned seed);
+std::vector<RouteQuery> generateLongHaulQueries(unsigned count, unsigned seed);
+
+// One query set per rank, from count / ranks sources, the set of rank r is at index r - MIN_QUERY_RANK
+std::vector<std::vector<RouteQuery>> generateRankQueries(unsigned count, unsigned seed);
+
+#endif /* ROUTINGBENCHMARK_H */
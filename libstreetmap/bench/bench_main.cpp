@@ -0,0 +1,131 @@
+/* Routing and courier benchmark runner
+ * Usage: bench_libstreetmap [--help] [--json report.json] [--seed n] [--queries n] [--penalties right left]
+ *                           [--courier [--best-known costs.txt] [--update-best-known]] [map_name ...]
+ * Loads each map in turn and runs every RoutingBenchmark workload on it, or with --courier every CourierBenchmark
+ * instance. The synthetic maps below are used when no map is given. Two runs with the same seed send the same
+ * queries and instances, so their JSON reports can be compared
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "m1.h"
+#include "util.h"
+#include "RoutingBenchmark.h"
+#include "CourierBenchmark.h"
+
+//Program exit codes
+constexpr int SUCCESS_EXIT_CODE = 0;        //Everything went OK
+constexpr int ERROR_EXIT_CODE = 1;          //An error occurred
+constexpr int BAD_ARGUMENTS_EXIT_CODE = 2;  //Invalid command-line usage
+
+static const std::vector<std::string> DEFAULT_MAPS = {
+    "synthetic_grid_10k",
+    "synthetic_grid_10k_highways_oneway30",
+    "synthetic_radial_10k_oneway30"
+};
+
+static void printUsage(std::ostream& out, const char* program) {
+    out << "Usage: " << program << " [--help] [--json report.json] [--seed n] [--queries n] [--penalties right left]\n"
+        << "       [--courier [--best-known costs.txt] [--update-best-known]] [map_name ...]\n";
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    std::string jsonPath;
+    std::string bestKnownPath;
+    bool courier = false;
+    bool updateBestKnown = false;
+    std::vector<std::string> maps;
+
+    try {
+        for (int arg = 1; arg < argc; arg++) {
+            std::string option = argv[arg];
+
+            if (option == "--help") {
+                printUsage(std::cout, argv[0]);
+                return SUCCESS_EXIT_CODE;
+            } else if (option == "--json" && arg + 1 < argc) {
+                jsonPath = argv[++arg];
+            } else if (option == "--seed" && arg + 1 < argc) {
+                options.seed = std::stoul(argv[++arg]);
+            } else if (option == "--queries" && arg + 1 < argc) {
+                options.queries = std::stoul(argv[++arg]);
+            } else if (option == "--penalties" && arg + 2 < argc) {
+                options.rightTurnPenalty = std::stod(argv[++arg]);
+                options.leftTurnPenalty = std::stod(argv[++arg]);
+            } else if (option == "--courier") {
+                courier = true;
+            } else if (option == "--best-known" && arg + 1 < argc) {
+                bestKnownPath = argv[++arg];
+            } else if (option == "--update-best-known") {
+                updateBestKnown = true;
+            } else if (option.substr(0, 2) == "--") {
+                printUsage(std::cerr, argv[0]);
+                return BAD_ARGUMENTS_EXIT_CODE;
+            } else {
+                maps.push_back(option);
+            }
+        }
+    } catch (const std::exception&) {
+        printUsage(std::cerr, argv[0]);
+        return BAD_ARGUMENTS_EXIT_CODE;
+    }
+
+    if (maps.empty()) maps = DEFAULT_MAPS;
+    if (updateBestKnown && bestKnownPath.empty()) {
+        std::cerr << "--update-best-known needs --best-known\n";
+        return BAD_ARGUMENTS_EXIT_CODE;
+    }
+
+    // The benchmark never looks up the user location
+    setenv("MAPPER_OFFLINE", "1", 0);
+
+    RoutingBenchmark benchmark(options);
+    CourierBenchmark courierBenchmark(options.seed, options.rightTurnPenalty, options.leftTurnPenalty);
+    bool success = true;
+
+    // A missing file is a first run, there is nothing known yet
+    if (!bestKnownPath.empty() && !courierBenchmark.loadBestKnown(bestKnownPath)) {
+        std::cout << "No best known costs in '" << bestKnownPath << "'\n";
+    }
+
+    for (auto map = maps.begin(); map != maps.end(); map++) {
+        std::string mapPath = getMapPath(*map);
+        store.mapName = *map;
+
+        if (!load_map(mapPath)) {
+            std::cerr << "Failed to load map '" << mapPath << "'\n";
+            success = false;
+            continue;
+        }
+
+        std::cout << "Benchmarking " << *map << " (" << getNumIntersections() << " intersections)\n";
+        if (courier) courierBenchmark.runMap(*map, getDefaultCourierScenarios());
+        else benchmark.runMap(*map);
+        close_map();
+    }
+
+    std::cout << (courier ? courierBenchmark.getSummary() : benchmark.getSummary());
+
+    bool written = jsonPath.empty() || (courier ? courierBenchmark.writeJSON(jsonPath) : benchmark.writeJSON(jsonPath));
+    if (!written) {
+        std::cerr << "Failed to write '" << jsonPath << "'\n";
+        success = false;
+    }
+
+    if (updateBestKnown && !courierBenchmark.saveBestKnown(bestKnownPath)) {
+        std::cerr << "Failed to write '" << bestKnownPath << "'\n";
+        success = false;
+    }
+
+    // Invalid routes fail the run
+    std::vector<CourierResult> courierResults = courierBenchmark.getResults();
+    for (auto result = courierResults.begin(); result != courierResults.end(); result++) {
+        if (!result->error.empty()) success = false;
+    }
+
+    return success ? SUCCESS_EXIT_CODE : ERROR_EXIT_CODE;
+}
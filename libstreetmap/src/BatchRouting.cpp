@@ -0,0 +1,38 @@
+#include "BatchRouting.h"
+#include "m3.h"
+#include "ReportUtil.h"
+
+#include <algorithm>
+#include <chrono>
+
+std::vector<RouteResult> findPathsInBatch(const std::vector<RouteRequest>& requests, unsigned threadCount, const RoutingEngine& engine) {
+    std::vector<RouteResult> results(requests.size());
+    if (requests.empty()) return results;
+
+    // Requests of a penalty pair run next to each other, in request order within the pair
+    std::vector<unsigned> order(requests.size());
+    for (unsigned request = 0; request < order.size(); request++) order[request] = request;
+    std::stable_sort(order.begin(), order.end(), [&requests](unsigned lhs, unsigned rhs) {
+        if (requests[lhs].rightTurnPenalty != requests[rhs].rightTurnPenalty) return requests[lhs].rightTurnPenalty < requests[rhs].rightTurnPenalty;
+        return requests[lhs].leftTurnPenalty < requests[rhs].leftTurnPenalty;
+    });
+
+    // Every request writes its own result, so workers never share anything but the read only graph
+    TaskGraph batch;
+    batch.addParallelTask("route batch", order.size(), std::max(threadCount, 1u) * BATCH_CHUNKS_PER_WORKER,
+            [&](unsigned begin, unsigned end, unsigned) {
+        for (unsigned index = begin; index < end; index++) {
+            const RouteRequest& request = requests[order[index]];
+            RouteResult& result = results[order[index]];
+
+            auto start = std::chrono::steady_clock::now();
+            result.path = engine(request.from, request.to, request.rightTurnPenalty, request.leftTurnPenalty);
+            result.searchTime = elapsedMilliseconds(start);
+
+            if (request.from != request.to) result.travelTime = compute_path_travel_time(result.path, request.rightTurnPenalty, request.leftTurnPenalty);
+        }
+    });
+    batch.run(threadCount);
+
+    return results;
+}
@@ -0,0 +1,44 @@
+/* Batch routing, runs many independent point to point queries on a pool of worker threads
+ * find_path_between_intersections keeps its search state in store.intersectionSearchNodes, so batches use a
+ * thread safe backend instead, where every worker thread searches with its own workspace
+ * Requests are grouped by penalty pair before they are split among the workers, so the metric of a pair is
+ * customized once and stays cached while its requests run. Results are returned in the order of the requests
+ */
+
+#ifndef BATCHROUTING_H
+#define BATCHROUTING_H
+
+#include <vector>
+
+#include "RoutingOracle.h"
+#include "TaskGraph.h"
+#include "TurnGraph.h"
+
+// Chunks each worker gets on average, more chunks balance uneven query times better
+#define BATCH_CHUNKS_PER_WORKER 8
+
+struct RouteRequest {
+    unsigned from;
+    unsigned to;
+    double rightTurnPenalty;
+    double leftTurnPenalty;
+};
+
+struct RouteResult {
+    std::vector<unsigned> path;
+
+    // compute_path_travel_time of the path, 0 from an intersection to itself and DBL_MAX if there is no path
+    double travelTime = 0;
+
+    // Time the backend took for this request in ms
+    double searchTime = 0;
+};
+
+/* Routes every request on threadCount threads, the calling thread included
+ * @params requests, threadCount, engine which must be safe to call from several threads at once
+ * @returns one result per request, in the order of the requests
+ */
+std::vector<RouteResult> findPathsInBatch(const std::vector<RouteRequest>& requests, unsigned threadCount = getWorkerCount(),
+        const RoutingEngine& engine = findTurnExactPath);
+
+#endif /* BATCHROUTING_H */
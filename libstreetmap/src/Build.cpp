@@ -1,48 +1,92 @@
 #include "Build.h"
 
-/* Builds OSMWays for StreetSegments
- * @params void
+#include <algorithm>
+#include <cfloat>
+#include <ctime>
+
+/* Builds OSMWays for StreetSegments in [begin, end) of the ways
+ * Joins each way with its segments through the sorted store.SEGMENT_WAY_IDS, ways without segments are skipped
+ * before their tags are read. Every segment belongs to one way, so ranges can be built concurrently once the segments are merged
+ * @params way index range
  * @returns void
  */
-void buildOSMWays() {
-    for (unsigned i = 0; i < getNumberOfWays(); i++) {
+void buildOSMWays(unsigned begin, unsigned end) {
+    auto compareOSMID = [](const std::pair<OSMID, unsigned>& lhs, const std::pair<OSMID, unsigned>& rhs) {
+        return lhs.first < rhs.first;
+    };
+    
+    // Draw level and colour of each highway type seen by this range, so each type is only looked up once
+    std::unordered_map<std::string, std::pair<int, ezgl::color>> highwayStyles;
+    
+    for (unsigned i = begin; i < end; i++) {
         const OSMWay* way = getWayByIndex(i);
         
         // Get ID range with the same OSMID, as multiple segments have the same OSMID
-        auto segmentIDRange = store.OSMID_SEGMENTID_MAP.equal_range(way->id());
-    
-        // For each segment get its draw properties, depending on the type
-        for (auto segmentID = segmentIDRange.first; segmentID != segmentIDRange.second; segmentID++) {
+        auto segmentIDRange = std::equal_range(store.SEGMENT_WAY_IDS.begin(), store.SEGMENT_WAY_IDS.end(), 
+                std::make_pair(way->id(), 0u), compareOSMID);
+        if (segmentIDRange.first == segmentIDRange.second) continue;
+        
+        // Only use the "highway" property
+        for(unsigned tagIndex = 0; tagIndex < getTagCount(way); tagIndex++) {
+            std::string key, type;
+            std::tie(key,type) = getTagPair(way, tagIndex);
+            if (key != "highway") continue;
             
-            for(unsigned tagIndex = 0; tagIndex < getTagCount(way); tagIndex++) {
-		std::string key, type;
-		std::tie(key,type) = getTagPair(way, tagIndex);
-               
-                // Only use the "highway" property
-		if (key == "highway") {
-                    store.SEGMENTS[segmentID->second]->setDrawLevel(getStreetDrawLevel(type));
-                    store.SEGMENTS[segmentID->second]->setSegmentColour(getStreetColour(type));
-                    store.SEGMENTS[segmentID->second]->setSegmentType(type);
-                    break;
-                }
-            }  
+            auto style = highwayStyles.find(type);
+            if (style == highwayStyles.end()) {
+                style = highwayStyles.insert(std::make_pair(type, std::make_pair(getStreetDrawLevel(type), getStreetColour(type)))).first;
+            }
+            
+            // For each segment set its draw properties, depending on the type
+            for (auto segmentID = segmentIDRange.first; segmentID != segmentIDRange.second; segmentID++) {
+                store.SEGMENTS[segmentID->second]->setDrawLevel(style->second.first);
+                store.SEGMENTS[segmentID->second]->setSegmentColour(style->second.second);
+                store.SEGMENTS[segmentID->second]->setSegmentType(style->first);
+            }
+            break;
         }
     }
 }
 
-/* Initial m1 build functions, to init map load */
-void buildIntersectionsVector() {
-    for (int intersection_id = 0; intersection_id < getNumIntersections(); intersection_id++) {
+/* Determines the bounds of the map from the intersections, and sets store.LAT_AVG
+ * Must be called before any build function that projects to world coordinates
+ * @params void
+ * @returns void
+ */
+void buildMapBounds() {
+    double lat_min = getIntersectionPosition(0).lat();
+    double lat_max = lat_min;
+    double lon_min = getIntersectionPosition(0).lon();
+    double lon_max = lon_min;
+    
+    for (int i = 0; i < getNumIntersections(); i++) {
+        LatLon coords = getIntersectionPosition(i);
+        
+        if (lat_min > coords.lat()) lat_min = coords.lat();
+        if (lat_max < coords.lat()) lat_max = coords.lat();
+        if (lon_min > coords.lon()) lon_min = coords.lon();
+        if (lon_max < coords.lon()) lon_max = coords.lon();
+    }
+    
+    store.LAT_AVG = (lat_min + lat_max)/2 * DEG_TO_RAD;
+    store.WORLD_BOUNDS = ezgl::rectangle({lonToX(lon_min), latToY(lat_min)}, {lonToX(lon_max), latToY(lat_max)});
+}
+
+/* Initial m1 build functions, to init map load 
+ * Range functions build [begin, end) of their ids, and only write to the entries of that range,
+ * or to a chunk result merged once every range has been built
+ */
+void buildIntersectionsVector(unsigned begin, unsigned end) {
+    std::vector<std::pair<std::string, NameEntry>> names;
+    std::vector<std::pair<std::string, unsigned>> tokenNames;
+    
+    for (unsigned intersection_id = begin; intersection_id < end; intersection_id++) {
       int segmentCount = getIntersectionStreetSegmentCount(intersection_id);
       
       std::vector<std::string> streetNames;
       std::vector<unsigned> segmentIDs;
       std::vector<unsigned> adjIntersections;
       
-      std::string intersectionName = getIntersectionName(intersection_id);
-      // transform to lower case for insertion to search dictionary
-      std::transform(intersectionName.begin(), intersectionName.end(), intersectionName.begin(), ::tolower);
-
       // Loop through each segment of the intersection
       for (int i = 0; i < segmentCount; i++) {
         StreetSegmentIndex segmentID = getIntersectionStreetSegment(i, intersection_id);
@@ -51,8 +95,8 @@ void buildIntersectionsVector() {
         streetNames.push_back(getStreetName(segmentInfo.streetID));
         
         // Get adjacent intersections
-        if (segmentInfo.to != intersection_id) adjIntersections.push_back(segmentInfo.to);
-        if (!segmentInfo.oneWay && segmentInfo.from != intersection_id) adjIntersections.push_back(segmentInfo.from);
+        if (segmentInfo.to != (int)intersection_id) adjIntersections.push_back(segmentInfo.to);
+        if (!segmentInfo.oneWay && segmentInfo.from != (int)intersection_id) adjIntersections.push_back(segmentInfo.from);
         
         // Intersections can be connected to itself, only if to == from
         if (segmentInfo.to == segmentInfo.from) adjIntersections.push_back(segmentInfo.from);
@@ -75,33 +119,19 @@ void buildIntersectionsVector() {
               intersection_id, getIntersectionName(intersection_id), 
               streetNames, adjIntersections, getIntersectionPosition(intersection_id));
       
-      // Push back ids into exisiting intersection names
-      if(store.INTERSECTION_DICTIONARY.find(intersectionName) != store.INTERSECTION_DICTIONARY.end()){
-          store.INTERSECTION_DICTIONARY.find(intersectionName)->second.push_back(intersection_id);
-      }else {
-          std::vector<unsigned> ids;
-          ids.push_back(intersection_id);
-          store.INTERSECTION_DICTIONARY.insert(std::make_pair(intersectionName, ids));
-      }
+      // Index the name for intersection search
+      std::string intersectionName = getIntersectionName(intersection_id);
+      names.push_back(std::make_pair(intersectionName, NameEntry{intersection_id, INTERSECTION_ENTITY}));
+      tokenNames.push_back(std::make_pair(intersectionName, intersection_id));
       
     }
+    
+    store.NAME_INDEX.insert(names);
+    store.INTERSECTION_TOKEN_INDEX.insert(tokenNames);
 }
 
-// Populate the dictionary with street names, POIs, and intersections
-void buildCompletionDictionary() {
-    for (int street_id = 0; street_id < getNumStreets(); street_id++) {
-        store.completionDictionary.insert(getStreetName(street_id));
-    }
-    for (int intersection_id = 0; intersection_id < getNumIntersections(); intersection_id++) {
-        store.completionDictionary.insert(getIntersectionName(intersection_id));
-    }
-    for (int poi_id = 0; poi_id < getNumPointsOfInterest(); poi_id++) {
-        store.completionDictionary.insert(getPointOfInterestName(poi_id));
-    }
-}
-
-void buildStreetSegments() {
-    for (int street_seg_id = 0; street_seg_id < getNumStreetSegments(); street_seg_id++) {
+void buildStreetSegments(unsigned begin, unsigned end, SegmentChunk& chunk) {
+    for (unsigned street_seg_id = begin; street_seg_id < end; street_seg_id++) {
         
         double segment_length = 0, travel_time, speedLimit;
         std::vector<LatLon> segment_points;
@@ -130,59 +160,128 @@ void buildStreetSegments() {
         
         speedLimit = segmentInfo.speedLimit;
         
-        if (store.topSpeedLimit < speedLimit) store.topSpeedLimit = speedLimit;
+        if (chunk.topSpeedLimit < speedLimit) chunk.topSpeedLimit = speedLimit;
       
         store.SEGMENTS[street_seg_id] = new StreetSegment(segmentInfo.streetID, segment_length, travel_time, segment_angles, segment_points, speedLimit, segmentInfo.oneWay);
-        store.OSMID_SEGMENTID_MAP.insert(std::make_pair(segmentInfo.wayOSMID, street_seg_id));
+        chunk.wayOSMIDs.push_back(std::make_pair(segmentInfo.wayOSMID, street_seg_id));
+    }
+}
+
+// Merges the segment chunks in order once every segment range is built, and sorts the way join
+void mergeStreetSegments(std::vector<SegmentChunk>& chunks) {
+    for (auto chunk = chunks.begin(); chunk != chunks.end(); chunk++) {
+        if (store.topSpeedLimit < chunk->topSpeedLimit) store.topSpeedLimit = chunk->topSpeedLimit;
+        
+        store.SEGMENT_WAY_IDS.insert(store.SEGMENT_WAY_IDS.end(), chunk->wayOSMIDs.begin(), chunk->wayOSMIDs.end());
+        chunk->wayOSMIDs.clear();
+    }
+    
+    std::sort(store.SEGMENT_WAY_IDS.begin(), store.SEGMENT_WAY_IDS.end());
+}
+
+// Collects the street of every segment in [begin, end), to be merged by mergeStreets
+void buildStreetSegmentLists(unsigned begin, unsigned end, StreetChunk& chunk) {
+    for (unsigned street_seg_id = begin; street_seg_id < end; street_seg_id++) {
+        InfoStreetSegment segmentInfo = getInfoStreetSegment(street_seg_id);
+        chunk.streetSegments.push_back(std::make_pair(segmentInfo.streetID, street_seg_id));
     }
 }
 
-void buildStreets() { 
+// Creates the streets, and adds the segments of every chunk in order
+void mergeStreets(std::vector<StreetChunk>& chunks) {
     for (int street_id = 0; street_id < getNumStreets(); street_id++) {        
         store.STREETS[street_id] = new Street(street_id, getStreetName(street_id));
     }
     
     // Adds all the segments to a street
-    for (int street_seg_id = 0; street_seg_id < getNumStreetSegments(); street_seg_id++) {
-        InfoStreetSegment segmentInfo = getInfoStreetSegment(street_seg_id);
-        store.STREETS[segmentInfo.streetID]->addSegment(street_seg_id);
+    for (auto chunk = chunks.begin(); chunk != chunks.end(); chunk++) {
+        for (auto segment = chunk->streetSegments.begin(); segment != chunk->streetSegments.end(); segment++) {
+            store.STREETS[segment->first]->addSegment(segment->second);
+        }
+        chunk->streetSegments.clear();
     }
+}
+
+// Completing street creation for [begin, end), needs every segment built and the streets merged
+void buildStreets(unsigned begin, unsigned end) { 
+    std::vector<std::pair<std::string, NameEntry>> names;
     
-    // Completing street creation
-    for (int street_id = 0; street_id < getNumStreets(); street_id++) {
-        std::string nameOfStreet = getStreetName(street_id);  
-        std::transform(nameOfStreet.begin(), nameOfStreet.end(), nameOfStreet.begin(), ::tolower);
-        store.STREETS_DICTIONARY.insert(std::make_pair(nameOfStreet, street_id));
+    for (unsigned street_id = begin; street_id < end; street_id++) {
+        names.push_back(std::make_pair(getStreetName(street_id), NameEntry{street_id, STREET_ENTITY}));
         
         store.STREETS[street_id]->clearSegmentDuplicates();
         store.STREETS[street_id]->generateIntersectionsList();
         store.STREETS[street_id]->calculateStreetLength();
     }
+    
+    store.NAME_INDEX.insert(names);
 }
 
 /*
- * Builds POI Dictionary by looping through all the POIS and inserting into POI_DICTIONARY
- * Manipulates store.POI_DICTIONARY
+ * Builds POI Dictionary by looping through the POIS in [begin, end) and inserting into the name index
+ * Manipulates store.NAME_INDEX
  */
-void buildPOIDictionary(){
-    for(int poi_id = 0; poi_id < getNumPointsOfInterest(); poi_id++){
-        std::string name = getPointOfInterestName(poi_id);
-        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
-        store.POI_DICTIONARY.insert(std::make_pair(name, poi_id));
+void buildPOIDictionary(unsigned begin, unsigned end){
+    std::vector<std::pair<std::string, NameEntry>> names;
+    
+    for(unsigned poi_id = begin; poi_id < end; poi_id++){
+        names.push_back(std::make_pair(getPointOfInterestName(poi_id), NameEntry{poi_id, POI_ENTITY}));
     }
+    
+    store.NAME_INDEX.insert(names);
 }
 
-/* Builds Feature objects with their corresponding draw properties 
- * @params void
+/* Lowest zoom level at which an extent covers at least one pixel of a REFERENCE_SCREEN_WIDTH wide screen
+ * Mirrors the zoom steps of getZoomedWorld, and must be called after buildMapBounds
+ * @params extent, largest side of the feature bounding box in world coordinates
+ * @returns zoom level, at most MAX_ZOOM_LEVEL
+ */
+static int getMinVisibleZoom(double extent) {
+    int zoom = 1;
+    double pixel = store.WORLD_BOUNDS.width() / (DEFAULT_ZOOM_SCALE) / REFERENCE_SCREEN_WIDTH;
+    
+    while (zoom < MAX_ZOOM_LEVEL && extent < pixel) {
+        zoom++;
+        pixel /= (DEFAULT_ZOOM_SCALE);
+    }
+    
+    return zoom;
+}
+
+/* Builds Feature objects with their corresponding draw properties, for features in [begin, end)
+ * Projects every feature point once into the chunk's points, and records the closure and bounding box
+ * so drawFeatures never needs to query the database
+ * Features are bucketed by type in paint order, which depends on the map, types not in the order are not drawn
+ * Each feature is only drawn from the zoom level where it covers a pixel, see sortFeatureBuckets
+ * @params feature index range, chunk to build into, merged by mergeFeatureMap
  * @returns void
  */
-void buildFeatureMap() {  
+void buildFeatureMap(unsigned begin, unsigned end, FeatureChunk& chunk) {  
+    //different priorities for different types of maps
+    FeatureType defaultFeaturePriorityArray[FEATURE_BUCKET_COUNT] = {Park, Lake, Island, Beach, River, Stream, Greenspace, Golfcourse, Building};
+    FeatureType islandFeaturePriorityArray[FEATURE_BUCKET_COUNT] = {Lake, Island, Beach, River, Stream, Greenspace, Golfcourse, Park, Building};
+    
+    FeatureType* featurePriorityArray = defaultFeaturePriorityArray;
+    if (store.mapName == "saint-helena" || store.mapName == "new-york_usa") {
+        featurePriorityArray = islandFeaturePriorityArray;
+    }
+    
+    // Bucket index of each feature type, types not drawn map to end
+    std::map<FeatureType, unsigned> bucketIndex;
+    for (int priority = 0; priority < FEATURE_BUCKET_COUNT; priority++) {
+        bucketIndex[featurePriorityArray[priority]] = priority;
+    }
+    chunk.buckets.assign(FEATURE_BUCKET_COUNT, std::vector<InternalFeature>());
+    
     // Must initialize colour
     ezgl::color colour = ezgl::BLACK;
    
-    for (int featureIndex = 0; featureIndex < getNumFeatures(); featureIndex++) {
+    for (unsigned featureIndex = begin; featureIndex < end; featureIndex++) {
         int drawZoomLevel = 1; // default zoom level
         FeatureType type = getFeatureType(featureIndex);
+        
+        auto bucket = bucketIndex.find(type);
+        if (bucket == bucketIndex.end()) continue;
 
         switch (type) {
             case River:
@@ -223,109 +322,175 @@ void buildFeatureMap() {
 
         }
         
-        // Insert data into feature object, and store into global store
-        InternalFeature* feature = new InternalFeature(featureIndex, colour, drawZoomLevel);
-        store.FEATURES_TYPE_MAP.insert(std::make_pair(getFeatureType(featureIndex), feature));
+        // Project points into the chunk's pool, offsets are relative to the chunk until merged
+        int count = getFeaturePointCount(featureIndex);
+        unsigned offset = chunk.points.size();
+        double x_min = DBL_MAX, x_max = -DBL_MAX, y_min = DBL_MAX, y_max = -DBL_MAX;
+        
+        for (int j = 0; j < count; j++) {
+            LatLon point = getFeaturePoint(j, featureIndex);
+            ezgl::point2d projected(lonToX(point.lon()), latToY(point.lat()));
+            
+            x_min = std::min(x_min, projected.x);
+            x_max = std::max(x_max, projected.x);
+            y_min = std::min(y_min, projected.y);
+            y_max = std::max(y_max, projected.y);
+            
+            chunk.points.push_back(projected);
+        }
+        
+        // Closed features have matching first and last points
+        bool closed = false;
+        if (count > 1) {
+            LatLon first = getFeaturePoint(0, featureIndex);
+            LatLon last = getFeaturePoint(count - 1, featureIndex);
+            closed = first.lat() == last.lat() && first.lon() == last.lon();
+        }
+        
+        ezgl::rectangle bounds({0, 0}, {0, 0});
+        if (count > 0) bounds = ezgl::rectangle({x_min, y_min}, {x_max, y_max});
+        
+        // Small features appear later than their type's zoom level
+        drawZoomLevel = std::max(drawZoomLevel, getMinVisibleZoom(std::max(bounds.width(), bounds.height())));
+        
+        // Insert data into feature object, and store into the chunk
+        InternalFeature feature(featureIndex, colour, drawZoomLevel);
+        feature.setGeometry(offset, count, closed, bounds);
+        
+        chunk.buckets[bucket->second].push_back(feature);
+    }
+}
+
+// Appends the chunks in order into store.FEATURE_POINTS and store.FEATURE_BUCKETS, rebasing the point offsets
+void mergeFeatureMap(std::vector<FeatureChunk>& chunks) {
+    store.FEATURE_BUCKETS.assign(FEATURE_BUCKET_COUNT, std::vector<InternalFeature>());
+    
+    for (auto chunk = chunks.begin(); chunk != chunks.end(); chunk++) {
+        unsigned base = store.FEATURE_POINTS.size();
+        store.FEATURE_POINTS.insert(store.FEATURE_POINTS.end(), chunk->points.begin(), chunk->points.end());
+        
+        for (unsigned bucket = 0; bucket < chunk->buckets.size(); bucket++) {
+            for (auto feature = chunk->buckets[bucket].begin(); feature != chunk->buckets[bucket].end(); feature++) {
+                feature->setGeometry(base + feature->getPointOffset(), feature->getPointCount(), feature->isClosed(), feature->getBounds());
+                store.FEATURE_BUCKETS[bucket].push_back(*feature);
+            }
+        }
+        
+        chunk->points.clear();
+        chunk->buckets.clear();
+    }
+}
+
+/* Sorts store.FEATURE_BUCKETS in [begin, end), once merged
+ * Features visible at lower zoom levels first, largest first within a level, so drawFeatures
+ * can stop at the first feature that is too small
+ */
+void sortFeatureBuckets(unsigned begin, unsigned end) {
+    for (unsigned bucket = begin; bucket < end; bucket++) {
+        std::sort(store.FEATURE_BUCKETS[bucket].begin(), store.FEATURE_BUCKETS[bucket].end(), [](InternalFeature& lhs, InternalFeature& rhs) {
+            if (lhs.getZoomLevel() != rhs.getZoomLevel()) return lhs.getZoomLevel() < rhs.getZoomLevel();
+            return lhs.getExtent() > rhs.getExtent();
+        });
     }
 }
 
 /* Builds initial bus routes vector with GET request to nextBus API with command routeList 
+ * A fresh on-disk cache is used instead when there is one, otherwise the request is made in the background,
+ * routes are added once the response is delivered and written back to the cache
  * To be used only with toronto_canada map 
  * @params void
  * @returns void
  */
 void buildBusRoutes() {
-    using namespace boost::property_tree;
-    ptree propertyTree;
-    
-    CURL *curlHandle = curl_easy_init();
-    store.responseBuffer = "";
-    
-    // Initialize request headers
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, "Accept: application/xml");
-    headers = curl_slist_append(headers, "charset: utf-8");
+    std::string cachePath = getBusCachePath();
+    if (loadBusCache(cachePath, BUS_CACHE_MAX_AGE)) return;
     
     std::string url = "http://webservices.nextbus.com/service/publicXMLFeed?command=routeList&a=ttc";
     
-    curl_easy_setopt(curlHandle, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curlHandle, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, curl_write);  
-    
-    // Get response from API
-    curl_easy_perform(curlHandle);
-    curl_slist_free_all(headers);
-    
-    // Transform responseBuffer to istream, and parse into property tree
-    std::istringstream inputStream(store.responseBuffer);
-    read_xml(inputStream, propertyTree);
-    
-    // Loop through the children of body attribute to get all the routes
-    BOOST_FOREACH(ptree::value_type const &value, propertyTree.get_child("body")) {
-        // Guard to check only "route" xml attributes
-        if (value.first == "route") {
-            // Create route object and insert into store.ROUTES
-            int routeTag = std::stoi(value.second.get("<xmlattr>.tag", "Error: did not get bus route"));
-            std::string routeName = value.second.get("<xmlattr>.title", "Error: did not get bus title");
-            
-            Route* route = new Route(routeTag, routeName);
-            store.routes.insert(std::make_pair(routeTag, route));
+    store.httpClient.get(url, BUS_ROUTES_TTL, [cachePath](const HttpResponse& response) {
+        using namespace boost::property_tree;
+        ptree propertyTree;
+        
+        // Without the API, stale cached routes are better than none
+        if (!response.success) {
+            loadBusCache(cachePath, DBL_MAX);
+            return;
         }
-    }
-    
-    curl_easy_cleanup(curlHandle);
+        
+        try {
+            // Transform response to istream, and parse into property tree
+            std::istringstream inputStream(response.body);
+            read_xml(inputStream, propertyTree);
+
+            // Loop through the children of body attribute to get all the routes
+            BOOST_FOREACH(ptree::value_type const &value, propertyTree.get_child("body")) {
+                // Guard to check only "route" xml attributes
+                if (value.first == "route") {
+                    // Create route object and insert into store.ROUTES, unless already built
+                    int routeTag = std::stoi(value.second.get("<xmlattr>.tag", "Error: did not get bus route"));
+                    std::string routeName = value.second.get("<xmlattr>.title", "Error: did not get bus title");
+                    if (store.routes.find(routeTag) != store.routes.end()) continue;
+
+                    Route* route = new Route(routeTag, routeName);
+                    store.routes.insert(std::make_pair(routeTag, route));
+                }
+            }
+        } catch (const std::exception&) {
+            // Malformed response, the routes built so far are kept, but not cached
+            return;
+        }
+        
+        // Stops that are still fresh in the old cache are kept
+        store.busRoutesFetched = std::time(nullptr);
+        loadCachedStops(cachePath, BUS_CACHE_MAX_AGE);
+        saveBusCache(cachePath);
+    }, getXMLRequestHeaders());
 }
 
 /* Builds bus stops given the route tag, is to be called only when bus is searched for the first time
- * Result is then built and cached into Route object
- * @params routeNumber (int)
+ * Result is then built and cached into Route object once the response is delivered
+ * @params routeNumber (int), built is called once the stops are cached
  * @returns void
  */
-void buildBusStops(int routeTag) {
-    using namespace boost::property_tree;
-    ptree propertyTree;
+void buildBusStops(int routeTag, std::function<void()> built) {
+    std::string url = "http://webservices.nextbus.com/service/publicXMLFeed?command=routeConfig&a=ttc&r=" + std::to_string(routeTag) + "&terse";
     
-    std::vector<std::pair<LatLon, int>> stopPoints;
+    store.httpClient.get(url, BUS_STOPS_TTL, [routeTag, built](const HttpResponse& response) {
+        using namespace boost::property_tree;
+        ptree propertyTree;
+        std::vector<std::pair<LatLon, int>> stopPoints;
+        if (!response.success) return;
+        
+        try {
+            // Parse into property trees
+            std::istringstream inputStream(response.body);
+            read_xml(inputStream, propertyTree);
 
-    CURL *curlHandle = curl_easy_init();
-    store.responseBuffer = "";
-    
-    // Initialize headers
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, "Accept: application/xml");
-    headers = curl_slist_append(headers, "charset: utf-8");
+            // For each children of the route, get the position and build into stopPoints
+            BOOST_FOREACH(ptree::value_type const &value, propertyTree.get_child("body").get_child("route")) {
+                if (value.first == "stop") {
+                    float lat = std::stof(value.second.get("<xmlattr>.lat", "-1"));
+                    float lon = std::stof(value.second.get("<xmlattr>.lon", "-1"));
+                    int id = std::stoi(value.second.get("<xmlattr>.stopId", "-1"));
 
-    std::string url = "http://webservices.nextbus.com/service/publicXMLFeed?command=routeConfig&a=ttc&r=" + std::to_string(routeTag) + "&terse";
-    
-    curl_easy_setopt(curlHandle, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curlHandle, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, curl_write);  
-    
-    // Get response
-    curl_easy_perform(curlHandle);
-    curl_slist_free_all(headers);
-    
-    // Parse into property trees
-    std::istringstream inputStream(store.responseBuffer);
-    read_xml(inputStream, propertyTree);
-    
-    // For each children of the route, get the position and build into stopPoints
-    BOOST_FOREACH(ptree::value_type const &value, propertyTree.get_child("body").get_child("route")) {
-        if (value.first == "stop") {
-            float lat = std::stof(value.second.get("<xmlattr>.lat", "-1"));
-            float lon = std::stof(value.second.get("<xmlattr>.lon", "-1"));
-            int id = std::stoi(value.second.get("<xmlattr>.stopId", "-1"));
-            
-            LatLon stop(lat, lon);
-            stopPoints.push_back(std::make_pair(stop, id));
+                    LatLon stop(lat, lon);
+                    stopPoints.push_back(std::make_pair(stop, id));
+                }
+            }
+        } catch (const std::exception&) {
+            return;
         }
-    }
-   
-    // Find the corresponding route, and cache the stop data
-    store.routes.find(routeTag)->second->setRouteStops(stopPoints);
-    store.routes.find(routeTag)->second->alreadyBuilt = true;
-    
-    curl_easy_cleanup(curlHandle);
+        
+        // Find the corresponding route, and cache the stop data
+        auto route = store.routes.find(routeTag);
+        if (route == store.routes.end()) return;
+        route->second->setRouteStops(stopPoints);
+        route->second->setStopsFetched(std::time(nullptr));
+        route->second->alreadyBuilt = true;
+        saveBusCache(getBusCachePath());
+        
+        built();
+    }, getXMLRequestHeaders());
 }
 
 /* Builds PNG_MAP to reduce file I/O request when using pngs
@@ -356,6 +521,9 @@ void buildCommandList(){
     std::string network = "/network    --       Enables networking";
     std::string weather = "/weather    --       Displays weather data of current map";
     std::string refresh = "/refresh      --       Refreshes the bus routes";
+    std::string profile = "/profile       --       Toggles render profiling (/profile csv to save)";
+    std::string isochrone = "/isochrone ##  --       Shows what is reachable within ## minutes \nof the selected intersection (/isochrone to clear)";
+    std::string nearest = "/nearest type  --       Shows the closest points of interest of a type \nby travel time from the selected intersection";
     std::string search = "You can search for any Point of Interest, Street, \nIntersection, or city/country in the search bar\n"
             "Map changes can be specified with either a valid \ncountry name search, or a 'city, country' pair";
     std::string busSearch = "To search for bus/streetcars use route ### - \nand click on the desired stop";
@@ -368,6 +536,9 @@ void buildCommandList(){
     store.commands.push_back(network);
     store.commands.push_back(weather);
     store.commands.push_back(refresh);
+    store.commands.push_back(profile);
+    store.commands.push_back(isochrone);
+    store.commands.push_back(nearest);
     store.commands.push_back(search);
     store.commands.push_back(busSearch);
     store.commands.push_back(directions);
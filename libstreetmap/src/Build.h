@@ -8,25 +8,50 @@
 #define BUILD_H
 
 #include "util.h"
+#include "BusCache.h"
+
+#define FEATURE_BUCKET_COUNT 9
+
+// Per-chunk results of the range build functions, merged once every chunk is built
+struct SegmentChunk {
+    double topSpeedLimit = 0;
+    std::vector<std::pair<OSMID, unsigned>> wayOSMIDs;
+};
+
+struct StreetChunk {
+    // street id, segment id
+    std::vector<std::pair<unsigned, unsigned>> streetSegments;
+};
+
+struct FeatureChunk {
+    std::vector<ezgl::point2d> points;
+    std::vector<std::vector<InternalFeature>> buckets;
+};
 
 // M1 build functions, for use in load_map, and initialize data sets
-void buildIntersectionsVector();
-void buildStreets();
-void buildStreetSegments(); 
-void buildOSMWays();
-void buildPOIDictionary();
-void buildCompletionDictionary();
+// Range functions build [begin, end) of their ids, see load_map for the order they depend on
+void buildMapBounds();
+void buildIntersectionsVector(unsigned begin, unsigned end);
+void buildStreetSegments(unsigned begin, unsigned end, SegmentChunk& chunk); 
+void mergeStreetSegments(std::vector<SegmentChunk>& chunks);
+void buildStreetSegmentLists(unsigned begin, unsigned end, StreetChunk& chunk);
+void mergeStreets(std::vector<StreetChunk>& chunks);
+void buildStreets(unsigned begin, unsigned end);
+void buildOSMWays(unsigned begin, unsigned end);
+void buildPOIDictionary(unsigned begin, unsigned end);
 
 // Builds PNG database
 // To be called only once, during the first initial canvas refresh
 void buildPNG(ezgl::renderer &g);
 
 // Build draw property objects
-void buildFeatureMap();
+void buildFeatureMap(unsigned begin, unsigned end, FeatureChunk& chunk);
+void mergeFeatureMap(std::vector<FeatureChunk>& chunks);
+void sortFeatureBuckets(unsigned begin, unsigned end);
 
 // Network related build functions to get live bus data
 void buildBusRoutes();
-void buildBusStops(int routeTag);
+void buildBusStops(int routeTag, std::function<void()> built);
 
 void buildCommandList();
 
@@ -0,0 +1,167 @@
+#include "BusCache.h"
+#include "Store.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sys/stat.h>
+
+// Limits on counts read from the file, so a corrupt cache fails instead of allocating
+#define BUS_CACHE_MAX_ROUTES 10000
+#define BUS_CACHE_MAX_STOPS 100000
+#define BUS_CACHE_MAX_NAME 1024
+
+static const char BUS_CACHE_MAGIC[4] = {'B', 'U', 'S', 'C'};
+
+struct CachedRoute {
+    int32_t tag = 0;
+    std::string name;
+    int64_t stopsFetched = 0;
+    std::vector<std::pair<LatLon, int>> stops;
+};
+
+struct CachedRouteList {
+    int64_t routesFetched = 0;
+    std::vector<CachedRoute> routes;
+};
+
+template <typename T>
+static bool readValue(std::istream& file, T& value) {
+    return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static void writeValue(std::ostream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static bool isFresh(int64_t fetched, double maxAge) {
+    return fetched > 0 && std::difftime(std::time(nullptr), (std::time_t)fetched) < maxAge;
+}
+
+/* Reads the whole cache file
+ * @params path, cache to fill
+ * @returns false if the file is missing, from another version or truncated
+ */
+static bool readBusCache(const std::string& path, CachedRouteList& cache) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    char magic[4];
+    uint32_t version, routeCount;
+    if (!file.read(magic, 4) || !std::equal(magic, magic + 4, BUS_CACHE_MAGIC)) return false;
+    if (!readValue(file, version) || version != BUS_CACHE_VERSION) return false;
+    if (!readValue(file, cache.routesFetched) || !readValue(file, routeCount) || routeCount > BUS_CACHE_MAX_ROUTES) return false;
+
+    cache.routes.resize(routeCount);
+    for (auto route = cache.routes.begin(); route != cache.routes.end(); route++) {
+        uint32_t nameLength, stopCount;
+        if (!readValue(file, route->tag) || !readValue(file, nameLength) || nameLength > BUS_CACHE_MAX_NAME) return false;
+
+        route->name.resize(nameLength);
+        if (nameLength > 0 && !file.read(&route->name[0], nameLength)) return false;
+        if (!readValue(file, route->stopsFetched) || !readValue(file, stopCount) || stopCount > BUS_CACHE_MAX_STOPS) return false;
+
+        route->stops.reserve(stopCount);
+        for (uint32_t stop = 0; stop < stopCount; stop++) {
+            float lat, lon;
+            int32_t id;
+            if (!readValue(file, lat) || !readValue(file, lon) || !readValue(file, id)) return false;
+            route->stops.push_back(std::make_pair(LatLon(lat, lon), id));
+        }
+    }
+
+    return true;
+}
+
+// Creates every missing directory of path, parents first
+static void makeDirectories(const std::string& path) {
+    for (std::size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        mkdir(path.substr(0, slash).c_str(), 0755);
+        if (slash == std::string::npos) break;
+    }
+}
+
+std::string getBusCachePath() {
+    const char* directory = std::getenv("MAPPER_CACHE_DIR");
+    if (directory != nullptr) return std::string(directory) + "/ttc_bus.bin";
+
+    const char* home = std::getenv("HOME");
+    return std::string(home != nullptr ? home : ".") + "/.cache/mapper/ttc_bus.bin";
+}
+
+bool loadBusCache(std::string path, double maxAge) {
+    CachedRouteList cache;
+    if (!readBusCache(path, cache) || !isFresh(cache.routesFetched, maxAge)) return false;
+
+    store.busRoutesFetched = cache.routesFetched;
+    for (auto cached = cache.routes.begin(); cached != cache.routes.end(); cached++) {
+        if (store.routes.find(cached->tag) != store.routes.end()) continue;
+
+        Route* route = new Route(cached->tag, cached->name);
+        if (isFresh(cached->stopsFetched, maxAge)) {
+            route->setRouteStops(cached->stops);
+            route->setStopsFetched(cached->stopsFetched);
+            route->alreadyBuilt = true;
+        }
+        store.routes.insert(std::make_pair(cached->tag, route));
+    }
+
+    return true;
+}
+
+void loadCachedStops(std::string path, double maxAge) {
+    CachedRouteList cache;
+    if (!readBusCache(path, cache)) return;
+
+    for (auto cached = cache.routes.begin(); cached != cache.routes.end(); cached++) {
+        auto route = store.routes.find(cached->tag);
+        if (route == store.routes.end() || route->second->alreadyBuilt || !isFresh(cached->stopsFetched, maxAge)) continue;
+
+        route->second->setRouteStops(cached->stops);
+        route->second->setStopsFetched(cached->stopsFetched);
+        route->second->alreadyBuilt = true;
+    }
+}
+
+bool saveBusCache(std::string path) {
+    std::size_t slash = path.rfind('/');
+    if (slash != std::string::npos && slash > 0) makeDirectories(path.substr(0, slash));
+
+    // Written to a temporary file then renamed, so a reader never sees a partial cache
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        file.write(BUS_CACHE_MAGIC, 4);
+        writeValue(file, (uint32_t)BUS_CACHE_VERSION);
+        writeValue(file, (int64_t)store.busRoutesFetched);
+        writeValue(file, (uint32_t)store.routes.size());
+
+        for (auto route = store.routes.begin(); route != store.routes.end(); route++) {
+            std::string name = route->second->getRouteName();
+            std::vector<std::pair<LatLon, int>> stops = route->second->getStopPoints();
+            bool hasStops = route->second->alreadyBuilt;
+
+            writeValue(file, (int32_t)route->first);
+            writeValue(file, (uint32_t)name.size());
+            file.write(name.data(), name.size());
+            writeValue(file, (int64_t)(hasStops ? route->second->getStopsFetched() : 0));
+            writeValue(file, (uint32_t)(hasStops ? stops.size() : 0));
+
+            for (auto stop = stops.begin(); hasStops && stop != stops.end(); stop++) {
+                writeValue(file, static_cast<float>(stop->first.lat()));
+                writeValue(file, static_cast<float>(stop->first.lon()));
+                writeValue(file, (int32_t)stop->second);
+            }
+        }
+
+        if (!file) return false;
+    }
+
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
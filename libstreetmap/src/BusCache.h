@@ -0,0 +1,31 @@
+/* On-disk cache of the TTC route list and the stops of every route searched so far
+ * The cache is a small binary file read without any XML parsing: a header with the time the route list
+ * was downloaded, then per route its tag, name, the time its stops were downloaded and the stops themselves
+ * Route geometry rarely changes, so cached data is used until it is older than BUS_CACHE_MAX_AGE
+ */
+
+#ifndef BUSCACHE_H
+#define BUSCACHE_H
+
+#include <string>
+
+#define BUS_CACHE_VERSION 1
+
+// Seconds the cached route list and stops are used before downloading them again
+#define BUS_CACHE_MAX_AGE (7 * 24 * 3600)
+
+// Cache file, in MAPPER_CACHE_DIR if set, otherwise in ~/.cache/mapper
+std::string getBusCachePath();
+
+/* Adds the cached routes to store.routes, with the stops that are younger than maxAge
+ * Returns false, without adding anything, if the cache is missing, unreadable or its route list is older than maxAge
+ */
+bool loadBusCache(std::string path, double maxAge);
+
+// Adds the cached stops younger than maxAge to the routes in store.routes that have no stops yet
+void loadCachedStops(std::string path, double maxAge);
+
+// Writes store.routes and store.busRoutesFetched, returns false if the file could not be written
+bool saveBusCache(std::string path);
+
+#endif /* BUSCACHE_H */
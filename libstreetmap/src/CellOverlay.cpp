@@ -0,0 +1,585 @@
+#include "CellOverlay.h"
+#include "util.h"
+#include "Store.h"
+#include "ReportUtil.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+
+void CellOverlay::build() {
+    levels.clear();
+    shortcutCount = 0;
+    intersectionCount = getNumIntersections();
+
+    partition();
+    for (auto level = levels.begin(); level != levels.end(); level++) findBoundaries(*level);
+    for (unsigned level = 1; level <= levels.size(); level++) buildCellGraphs(level);
+
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    metrics.clear();
+}
+
+// Splits the intersections in halves at the median of the longer side, until every part fits in a finest cell
+// Part p of the last split is cell p >> (l - 1) * OVERLAY_LEVEL_BISECTIONS of level l, so levels nest
+void CellOverlay::partition() {
+    unsigned depth = 0;
+    while (intersectionCount > ((unsigned)OVERLAY_CELL_SIZE << depth)) depth++;
+
+    std::vector<unsigned> order(intersectionCount);
+    for (unsigned intersection = 0; intersection < intersectionCount; intersection++) order[intersection] = intersection;
+
+    std::vector<unsigned> bounds = {0, intersectionCount};
+    for (unsigned split = 0; split < depth; split++) {
+        std::vector<unsigned> halves = {0};
+
+        for (unsigned part = 0; part + 1 < bounds.size(); part++) {
+            auto begin = order.begin() + bounds[part];
+            auto end = order.begin() + bounds[part + 1];
+            if (begin == end) {
+                halves.insert(halves.end(), 2, bounds[part + 1]);
+                continue;
+            }
+
+            double minLat = 90, maxLat = -90, minLon = 180, maxLon = -180;
+            for (auto intersection = begin; intersection != end; intersection++) {
+                LatLon position = getIntersectionPosition(*intersection);
+                minLat = std::min<double>(minLat, position.lat());
+                maxLat = std::max<double>(maxLat, position.lat());
+                minLon = std::min<double>(minLon, position.lon());
+                maxLon = std::max<double>(maxLon, position.lon());
+            }
+            bool byLat = maxLat - minLat >= (maxLon - minLon) * cos((minLat + maxLat) / 2 * DEG_TO_RAD);
+
+            auto middle = begin + (end - begin) / 2;
+            std::nth_element(begin, middle, end, [byLat](unsigned lhs, unsigned rhs) {
+                LatLon left = getIntersectionPosition(lhs), right = getIntersectionPosition(rhs);
+                if (byLat) return left.lat() < right.lat() || (left.lat() == right.lat() && lhs < rhs);
+                return left.lon() < right.lon() || (left.lon() == right.lon() && lhs < rhs);
+            });
+
+            halves.push_back(middle - order.begin());
+            halves.push_back(bounds[part + 1]);
+        }
+        bounds.swap(halves);
+    }
+
+    for (unsigned level = 1; level <= OVERLAY_MAX_LEVELS; level++) {
+        unsigned shift = (level - 1) * OVERLAY_LEVEL_BISECTIONS;
+        if (shift >= depth) break;
+
+        OverlayLevel cells;
+        cells.cellCount = 1u << (depth - shift);
+        cells.cells.resize(intersectionCount);
+        for (unsigned part = 0; part + 1 < bounds.size(); part++) {
+            for (unsigned position = bounds[part]; position < bounds[part + 1]; position++) cells.cells[order[position]] = part >> shift;
+        }
+        levels.push_back(cells);
+    }
+}
+
+// Every directed segment between two cells is an entry of the cell it ends in and an exit of the cell it starts in
+void CellOverlay::findBoundaries(OverlayLevel& level) {
+    const TurnGraph& graph = store.turnGraph;
+
+    std::vector<std::vector<unsigned>> entries(level.cellCount), exits(level.cellCount);
+    for (unsigned intersection = 0; intersection < intersectionCount; intersection++) {
+        std::vector<unsigned> outgoing = graph.getOutgoingEdges(intersection);
+        for (auto edge = outgoing.begin(); edge != outgoing.end(); edge++) {
+            unsigned from = level.cells[intersection], to = level.cells[graph.getEdgeHead(*edge)];
+            if (from == to) continue;
+
+            exits[from].push_back(*edge);
+            entries[to].push_back(*edge);
+        }
+    }
+
+    level.entryOffsets.assign(1, 0);
+    level.exitOffsets.assign(1, 0);
+    level.shortcutOffsets.assign(1, 0);
+    level.entryIndices.assign(graph.getEdgeCount(), NO_ENTRY);
+    for (unsigned cell = 0; cell < level.cellCount; cell++) {
+        for (unsigned entry = 0; entry < entries[cell].size(); entry++) level.entryIndices[entries[cell][entry]] = entry;
+
+        level.entries.insert(level.entries.end(), entries[cell].begin(), entries[cell].end());
+        level.exits.insert(level.exits.end(), exits[cell].begin(), exits[cell].end());
+        level.entryOffsets.push_back(level.entries.size());
+        level.exitOffsets.push_back(level.exits.size());
+        level.shortcutOffsets.push_back(level.shortcutOffsets.back() + entries[cell].size() * exits[cell].size());
+    }
+    shortcutCount += level.shortcutOffsets.back();
+}
+
+// Arcs out of a node never leave its cell, they end at another node of the cell or at one of its exits
+void CellOverlay::buildCellGraphs(unsigned level) {
+    const TurnGraph& graph = store.turnGraph;
+    OverlayLevel& cells = levels[level - 1];
+
+    std::vector<std::vector<unsigned>> inside(cells.cellCount);
+    if (level == 1) {
+        for (unsigned edge = 0; edge < graph.getEdgeCount(); edge++) inside[cells.cells[graph.getEdgeHead(edge)]].push_back(edge);
+    } else {
+        const std::vector<unsigned>& belowEntries = levels[level - 2].entries;
+        for (auto edge = belowEntries.begin(); edge != belowEntries.end(); edge++) inside[cells.cells[graph.getEdgeHead(*edge)]].push_back(*edge);
+    }
+
+    // Node of each directed segment in the cell being built, only read for segments of that cell
+    std::vector<unsigned> nodes(graph.getEdgeCount(), NO_ENTRY);
+    std::vector<unsigned> belowLists(level == 1 ? 0 : levels[level - 2].cellCount, NO_ENTRY);
+
+    cells.nodeOffsets.assign(1, 0);
+    cells.targetLists.clear();
+    cells.targetOffsets.assign(1, 0);
+    cells.targets.clear();
+    cells.costOffsets.clear();
+    cells.entryNodes.assign(cells.entries.size(), NO_ENTRY);
+    cells.maxCellNodes = 0;
+    cells.eliminationOffsets.assign(1, 0);
+    cells.eliminated.clear();
+    cells.neighbourOffsets.assign(1, 0);
+    cells.predecessorCounts.clear();
+    cells.neighbours.clear();
+    for (unsigned cell = 0; cell < cells.cellCount; cell++) {
+        unsigned exitBegin = cells.exitOffsets[cell], exitEnd = cells.exitOffsets[cell + 1];
+        for (unsigned node = 0; node < inside[cell].size(); node++) nodes[inside[cell][node]] = node;
+        for (unsigned exit = exitBegin; exit < exitEnd; exit++) nodes[cells.exits[exit]] = inside[cell].size() + exit - exitBegin;
+
+        for (auto edge = inside[cell].begin(); edge != inside[cell].end(); edge++) {
+            if (level == 1) {
+                cells.targetLists.push_back(cells.targetOffsets.size() - 1);
+                cells.costOffsets.push_back(graph.getArcBegin(*edge));
+                for (unsigned arc = graph.getArcBegin(*edge); arc < graph.getArcEnd(*edge); arc++) {
+                    cells.targets.push_back(nodes[graph.getArcTargets()[arc]]);
+                }
+                cells.targetOffsets.push_back(cells.targets.size());
+                continue;
+            }
+
+            // An entry of a cell below leads to that cell's exits, at its row of that level's shortcuts
+            const OverlayLevel& below = levels[level - 2];
+            unsigned belowCell = below.cells[graph.getEdgeHead(*edge)];
+            unsigned belowExitCount = below.exitOffsets[belowCell + 1] - below.exitOffsets[belowCell];
+            if (belowLists[belowCell] == NO_ENTRY) {
+                belowLists[belowCell] = cells.targetOffsets.size() - 1;
+                for (unsigned exit = below.exitOffsets[belowCell]; exit < below.exitOffsets[belowCell + 1]; exit++) {
+                    cells.targets.push_back(nodes[below.exits[exit]]);
+                }
+                cells.targetOffsets.push_back(cells.targets.size());
+            }
+            cells.targetLists.push_back(belowLists[belowCell]);
+            cells.costOffsets.push_back(below.shortcutOffsets[belowCell] + below.entryIndices[*edge] * belowExitCount);
+        }
+
+        // Exits have no arcs inside the cell
+        cells.targetLists.insert(cells.targetLists.end(), exitEnd - exitBegin, 0);
+        cells.costOffsets.insert(cells.costOffsets.end(), exitEnd - exitBegin, 0);
+
+        for (unsigned entry = cells.entryOffsets[cell]; entry < cells.entryOffsets[cell + 1]; entry++) {
+            cells.entryNodes[entry] = nodes[cells.entries[entry]];
+        }
+        cells.nodeOffsets.push_back(cells.targetLists.size());
+        cells.maxCellNodes = std::max<unsigned>(cells.maxCellNodes, inside[cell].size() + exitEnd - exitBegin);
+
+        orderEliminations(cells, cell);
+        cells.eliminationOffsets.push_back(cells.eliminated.size());
+    }
+
+    cells.targetLists.shrink_to_fit();
+    cells.targets.shrink_to_fit();
+    cells.costOffsets.shrink_to_fit();
+    cells.eliminated.shrink_to_fit();
+    cells.neighbourOffsets.shrink_to_fit();
+    cells.predecessorCounts.shrink_to_fit();
+    cells.neighbours.shrink_to_fit();
+}
+
+// Greedy, the joins of a node are its predecessor count times its successor count among the nodes left
+void CellOverlay::orderEliminations(OverlayLevel& cells, unsigned cell) const {
+    unsigned base = cells.nodeOffsets[cell];
+    unsigned nodeCount = cells.nodeOffsets[cell + 1] - base;
+    unsigned firstExit = nodeCount - (cells.exitOffsets[cell + 1] - cells.exitOffsets[cell]);
+
+    // Arcs between the nodes left in the cell, a bit row of successors and of predecessors per node
+    unsigned words = (nodeCount + 63) / 64;
+    std::vector<uint64_t> successorBits(nodeCount * words, 0), predecessorBits(nodeCount * words, 0);
+    for (unsigned node = 0; node < firstExit; node++) {
+        unsigned list = cells.targetLists[base + node];
+        for (unsigned target = cells.targetOffsets[list]; target < cells.targetOffsets[list + 1]; target++) {
+            if (cells.targets[target] == node) continue;
+            successorBits[node * words + cells.targets[target] / 64] |= (uint64_t)1 << (cells.targets[target] % 64);
+            predecessorBits[cells.targets[target] * words + node / 64] |= (uint64_t)1 << (node % 64);
+        }
+    }
+
+    auto countBits = [words](const uint64_t* bits) {
+        unsigned count = 0;
+        for (unsigned word = 0; word < words; word++) count += __builtin_popcountll(bits[word]);
+        return count;
+    };
+    auto appendBits = [words, &cells](const uint64_t* bits) {
+        for (unsigned word = 0; word < words; word++) {
+            for (uint64_t left = bits[word]; left != 0; left &= left - 1) cells.neighbours.push_back(word * 64 + __builtin_ctzll(left));
+        }
+    };
+
+    std::vector<unsigned> predecessorTotals(nodeCount), successorTotals(nodeCount);
+    for (unsigned node = 0; node < nodeCount; node++) {
+        predecessorTotals[node] = countBits(&predecessorBits[node * words]);
+        successorTotals[node] = countBits(&successorBits[node * words]);
+    }
+
+    std::vector<char> pending(nodeCount, 0);
+    std::fill(pending.begin(), pending.begin() + firstExit, 1);
+    for (unsigned entry = cells.entryOffsets[cell]; entry < cells.entryOffsets[cell + 1]; entry++) pending[cells.entryNodes[entry]] = 0;
+    unsigned pendingCount = std::count(pending.begin(), pending.end(), 1);
+
+    for (; pendingCount > 0; pendingCount--) {
+        unsigned next = 0;
+        unsigned long long fewest = ULLONG_MAX;
+        for (unsigned node = 0; node < firstExit; node++) {
+            unsigned long long joins = (unsigned long long)predecessorTotals[node] * successorTotals[node];
+            if (pending[node] && joins < fewest) {
+                next = node;
+                fewest = joins;
+            }
+        }
+        pending[next] = 0;
+        cells.eliminated.push_back(next);
+
+        unsigned predecessorsBegin = cells.neighbours.size();
+        appendBits(&predecessorBits[next * words]);
+        unsigned successorsBegin = cells.neighbours.size();
+        appendBits(&successorBits[next * words]);
+        cells.predecessorCounts.push_back(successorsBegin - predecessorsBegin);
+        cells.neighbourOffsets.push_back(cells.neighbours.size());
+
+        // The removed node's arcs are replaced by the joins around it, without loops
+        for (unsigned predecessor = predecessorsBegin; predecessor < successorsBegin; predecessor++) {
+            unsigned node = cells.neighbours[predecessor];
+            uint64_t* successorsOfNode = &successorBits[node * words];
+            for (unsigned word = 0; word < words; word++) successorsOfNode[word] |= successorBits[next * words + word];
+            successorsOfNode[next / 64] &= ~((uint64_t)1 << (next % 64));
+            successorsOfNode[node / 64] &= ~((uint64_t)1 << (node % 64));
+            successorTotals[node] = countBits(successorsOfNode);
+        }
+        for (unsigned successor = successorsBegin; successor < cells.neighbours.size(); successor++) {
+            unsigned node = cells.neighbours[successor];
+            uint64_t* predecessorsOfNode = &predecessorBits[node * words];
+            for (unsigned word = 0; word < words; word++) predecessorsOfNode[word] |= predecessorBits[next * words + word];
+            predecessorsOfNode[next / 64] &= ~((uint64_t)1 << (next % 64));
+            predecessorsOfNode[node / 64] &= ~((uint64_t)1 << (node % 64));
+            predecessorTotals[node] = countBits(predecessorsOfNode);
+        }
+    }
+}
+
+void CellOverlay::clear() {
+    levels.clear();
+    intersectionCount = 0;
+    shortcutCount = 0;
+
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    metrics.clear();
+}
+
+// Shortcuts of a level are cheapest paths over the level below, so levels are customized finest first
+OverlayMetric CellOverlay::customize(double rightTurnPenalty, double leftTurnPenalty) const {
+    auto start = std::chrono::steady_clock::now();
+
+    OverlayMetric metric;
+    metric.turnMetric = store.turnGraph.getMetric(rightTurnPenalty, leftTurnPenalty);
+    metric.shortcutCosts.resize(levels.size());
+
+    for (unsigned level = 1; level <= levels.size(); level++) {
+        const OverlayLevel& cells = levels[level - 1];
+        const std::vector<double>& belowCosts = level == 1 ? metric.turnMetric->arcCosts : metric.shortcutCosts[level - 2];
+        std::vector<double>& costs = metric.shortcutCosts[level - 1];
+        costs.assign(cells.shortcutOffsets.back(), DBL_MAX);
+
+        #pragma omp parallel
+        {
+            std::vector<double> matrix(cells.maxCellNodes * cells.maxCellNodes);
+
+            #pragma omp for schedule(dynamic)
+            for (unsigned cell = 0; cell < cells.cellCount; cell++) customizeCell(level, cell, belowCosts, costs, matrix);
+        }
+    }
+
+    metric.customizationTime = elapsedMilliseconds(start);
+    return metric;
+}
+
+void CellOverlay::customizeCell(unsigned level, unsigned cell, const std::vector<double>& belowCosts, std::vector<double>& costs,
+        std::vector<double>& matrix) const {
+    const OverlayLevel& cells = levels[level - 1];
+    unsigned base = cells.nodeOffsets[cell];
+    unsigned nodeCount = cells.nodeOffsets[cell + 1] - base;
+    unsigned exitCount = cells.exitOffsets[cell + 1] - cells.exitOffsets[cell];
+    unsigned firstExit = nodeCount - exitCount;
+
+    // Cost from node a to node b is matrix[a * nodeCount + b], DBL_MAX without an arc
+    std::fill(matrix.begin(), matrix.begin() + nodeCount * nodeCount, DBL_MAX);
+    for (unsigned node = 0; node < firstExit; node++) {
+        unsigned list = cells.targetLists[base + node];
+        unsigned cost = cells.costOffsets[base + node];
+        for (unsigned target = cells.targetOffsets[list]; target < cells.targetOffsets[list + 1]; target++, cost++) {
+            double& arc = matrix[node * nodeCount + cells.targets[target]];
+            arc = std::min(arc, belowCosts[cost]);
+        }
+    }
+
+    // A missing arc at DBL_MAX never improves on a cost
+    for (unsigned step = cells.eliminationOffsets[cell]; step < cells.eliminationOffsets[cell + 1]; step++) {
+        const double* fromNode = &matrix[cells.eliminated[step] * nodeCount];
+        unsigned successorsBegin = cells.neighbourOffsets[step] + cells.predecessorCounts[step];
+
+        for (unsigned predecessor = cells.neighbourOffsets[step]; predecessor < successorsBegin; predecessor++) {
+            double* fromPredecessor = &matrix[cells.neighbours[predecessor] * nodeCount];
+            double toNode = fromPredecessor[cells.eliminated[step]];
+            if (toNode == DBL_MAX) continue;
+
+            for (unsigned successor = successorsBegin; successor < cells.neighbourOffsets[step + 1]; successor++) {
+                unsigned target = cells.neighbours[successor];
+                if (toNode + fromNode[target] < fromPredecessor[target]) fromPredecessor[target] = toNode + fromNode[target];
+            }
+        }
+    }
+
+    for (unsigned entry = cells.entryOffsets[cell]; entry < cells.entryOffsets[cell + 1]; entry++) {
+        const double* fromEntry = &matrix[cells.entryNodes[entry] * nodeCount + firstExit];
+        std::copy(fromEntry, fromEntry + exitCount, costs.begin() + cells.shortcutOffsets[cell] + (entry - cells.entryOffsets[cell]) * exitCount);
+    }
+}
+
+// Customizing takes a while on big maps, so it runs outside the lock and queries on cached metrics are not held up
+std::shared_ptr<const OverlayMetric> CellOverlay::getMetric(double rightTurnPenalty, double leftTurnPenalty) {
+    auto findCached = [&]() -> std::shared_ptr<const OverlayMetric> {
+        for (auto metric = metrics.begin(); metric != metrics.end(); metric++) {
+            const TurnMetric& turnMetric = *(*metric)->turnMetric;
+            if (turnMetric.rightTurnPenalty != rightTurnPenalty || turnMetric.leftTurnPenalty != leftTurnPenalty) continue;
+
+            // Move to the back, most recently used
+            std::shared_ptr<const OverlayMetric> found = *metric;
+            metrics.erase(metric);
+            metrics.push_back(found);
+            return found;
+        }
+        return nullptr;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        std::shared_ptr<const OverlayMetric> cached = findCached();
+        if (cached) return cached;
+    }
+
+    std::shared_ptr<const OverlayMetric> metric = std::make_shared<const OverlayMetric>(customize(rightTurnPenalty, leftTurnPenalty));
+
+    // Another thread may have published the same pair while this one customized, the first one is kept
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::shared_ptr<const OverlayMetric> cached = findCached();
+    if (cached) return cached;
+
+    if (metrics.size() == OVERLAY_METRIC_CACHE_SIZE) metrics.erase(metrics.begin());
+    metrics.push_back(metric);
+    return metric;
+}
+
+template <typename Reach>
+void CellOverlay::relaxArcs(unsigned level, unsigned edge, double time, const OverlayMetric& metric, Reach& reach) const {
+    const TurnGraph& graph = store.turnGraph;
+
+    if (level == 0) {
+        const std::vector<unsigned>& targets = graph.getArcTargets();
+        const std::vector<double>& costs = metric.turnMetric->arcCosts;
+        for (unsigned arc = graph.getArcBegin(edge), end = graph.getArcEnd(edge); arc < end; arc++) {
+            reach(targets[arc], time + costs[arc], edge);
+        }
+        return;
+    }
+
+    // Shortcuts from an entry to every exit of its cell
+    const OverlayLevel& cells = levels[level - 1];
+    const std::vector<double>& costs = metric.shortcutCosts[level - 1];
+    unsigned cell = cells.cells[graph.getEdgeHead(edge)];
+    unsigned exitCount = cells.exitOffsets[cell + 1] - cells.exitOffsets[cell];
+    unsigned row = cells.shortcutOffsets[cell] + cells.entryIndices[edge] * exitCount;
+
+    for (unsigned exit = 0; exit < exitCount; exit++) {
+        if (costs[row + exit] == DBL_MAX) continue;
+        reach(cells.exits[cells.exitOffsets[cell] + exit], time + costs[row + exit], edge);
+    }
+}
+
+unsigned CellOverlay::searchCell(unsigned level, unsigned source, const OverlayMetric& metric, TurnSearchWorkspace& workspace,
+        int target, SearchStats& stats) const {
+    const TurnGraph& graph = store.turnGraph;
+    const std::vector<unsigned>& cells = levels[level - 1].cells;
+    unsigned cell = cells[graph.getEdgeHead(source)];
+    unsigned exitsLeft = levels[level - 1].exitOffsets[cell + 1] - levels[level - 1].exitOffsets[cell];
+    unsigned generation = workspace.startSearch(graph.getEdgeCount());
+    stats.searches++;
+
+    std::priority_queue<TurnWave, std::vector<TurnWave>, std::greater<TurnWave>> wavefront;
+
+    auto reach = [&](unsigned edge, double time, int reachingEdge) {
+        if (workspace.visited[edge] == generation && workspace.bestTimes[edge] <= time) return;
+
+        workspace.visited[edge] = generation;
+        workspace.bestTimes[edge] = time;
+        workspace.reachingEdges[edge] = reachingEdge;
+        wavefront.push(TurnWave{time, time, edge});
+        stats.heapPushes++;
+    };
+    reach(source, 0, NO_EDGE);
+
+    while (!wavefront.empty()) {
+        TurnWave wave = wavefront.top();
+        wavefront.pop();
+        stats.heapPops++;
+
+        unsigned edge = wave.edge;
+        if (wave.travelTime > workspace.bestTimes[edge]) continue;
+        stats.settledNodes++;
+
+        // Exits lead out of the cell, a search of the whole cell is done once every exit is settled
+        if ((int)edge == target) break;
+        if (cells[graph.getEdgeHead(edge)] != cell) {
+            if (--exitsLeft == 0 && target == NO_EDGE) break;
+            continue;
+        }
+
+        relaxArcs(level - 1, edge, wave.travelTime, metric, reach);
+    }
+
+    return generation;
+}
+
+unsigned CellOverlay::getQueryLevel(unsigned edge, unsigned from, unsigned to) const {
+    unsigned head = store.turnGraph.getEdgeHead(edge);
+
+    for (unsigned level = levels.size(); level > 0; level--) {
+        const std::vector<unsigned>& cells = levels[level - 1].cells;
+        if (cells[head] != cells[from] && cells[head] != cells[to]) return level;
+    }
+    return 0;
+}
+
+void CellOverlay::unpack(unsigned level, unsigned source, unsigned target, const OverlayMetric& metric,
+        TurnSearchWorkspace& workspace, SearchStats& stats, std::vector<unsigned>& path) const {
+    searchCell(level, source, metric, workspace, target, stats);
+
+    // The workspace is reused by the searches below, so the shortcut's path is copied out first
+    std::vector<unsigned> edges;
+    for (int edge = target; edge != (int)source; edge = workspace.reachingEdges[edge]) edges.push_back(edge);
+    std::reverse(edges.begin(), edges.end());
+
+    unsigned previous = source;
+    for (auto edge = edges.begin(); edge != edges.end(); edge++) {
+        if (level == 1) path.push_back(*edge / 2);
+        else unpack(level - 1, previous, *edge, metric, workspace, stats, path);
+        previous = *edge;
+    }
+}
+
+std::vector<unsigned> CellOverlay::findPath(unsigned from, unsigned to, const OverlayMetric& metric, TurnSearchWorkspace& workspace) const {
+    std::vector<unsigned> path;
+    if (from == to || from >= intersectionCount || to >= intersectionCount) return path;
+
+    const TurnGraph& graph = store.turnGraph;
+    unsigned generation = workspace.startSearch(graph.getEdgeCount());
+
+    SearchStats stats;
+    stats.searches = 1;
+
+    std::priority_queue<TurnWave, std::vector<TurnWave>, std::greater<TurnWave>> wavefront;
+
+    auto reach = [&](unsigned edge, double time, int reachingEdge) {
+        if (workspace.visited[edge] == generation && workspace.bestTimes[edge] <= time) return;
+
+        workspace.visited[edge] = generation;
+        workspace.bestTimes[edge] = time;
+        workspace.reachingEdges[edge] = reachingEdge;
+        wavefront.push(TurnWave{time + heuristic(graph.getEdgeHead(edge), to), time, edge});
+        stats.heapPushes++;
+    };
+
+    std::vector<unsigned> outgoing = graph.getOutgoingEdges(from);
+    for (auto edge = outgoing.begin(); edge != outgoing.end(); edge++) reach(*edge, graph.getEdgeTime(*edge), NO_EDGE);
+
+    int found = NO_EDGE;
+    while (!wavefront.empty()) {
+        TurnWave wave = wavefront.top();
+        wavefront.pop();
+        stats.heapPops++;
+
+        // Skip entries left behind by a cheaper arrival
+        unsigned edge = wave.edge;
+        if (wave.travelTime > workspace.bestTimes[edge]) continue;
+        stats.settledNodes++;
+
+        if (graph.getEdgeHead(edge) == to) {
+            found = edge;
+            break;
+        }
+
+        relaxArcs(getQueryLevel(edge, from, to), edge, wave.travelTime, metric, reach);
+    }
+
+    std::vector<unsigned> edges;
+    for (int edge = found; edge != NO_EDGE; edge = workspace.reachingEdges[edge]) edges.push_back(edge);
+    std::reverse(edges.begin(), edges.end());
+
+    // Arcs taken at a level above the turn graph are shortcuts
+    for (unsigned edge = 0; edge < edges.size(); edge++) {
+        unsigned level = edge == 0 ? 0 : getQueryLevel(edges[edge - 1], from, to);
+        if (level == 0) path.push_back(edges[edge] / 2);
+        else unpack(level, edges[edge - 1], edges[edge], metric, workspace, stats, path);
+    }
+    recordSearch(stats);
+
+    return path;
+}
+
+unsigned CellOverlay::getLevelCount() const {
+    return levels.size();
+}
+
+unsigned CellOverlay::getCellCount(unsigned level) const {
+    return levels[level - 1].cellCount;
+}
+
+unsigned CellOverlay::getCell(unsigned level, unsigned intersection) const {
+    return levels[level - 1].cells[intersection];
+}
+
+unsigned CellOverlay::getShortcutCount() const {
+    return shortcutCount;
+}
+
+// Cells and boundaries only, metrics are counted by their owners
+std::size_t CellOverlay::getMemoryUsage() const {
+    std::size_t bytes = 0;
+    for (auto level = levels.begin(); level != levels.end(); level++) {
+        bytes += (level->cells.capacity() + level->entryOffsets.capacity() + level->entries.capacity() + level->exitOffsets.capacity()
+                + level->exits.capacity() + level->entryIndices.capacity() + level->shortcutOffsets.capacity()
+                + level->nodeOffsets.capacity() + level->targetLists.capacity() + level->targetOffsets.capacity()
+                + level->targets.capacity() + level->costOffsets.capacity() + level->entryNodes.capacity()
+                + level->eliminationOffsets.capacity() + level->eliminated.capacity() + level->neighbourOffsets.capacity()
+                + level->predecessorCounts.capacity()) * sizeof(unsigned) + level->neighbours.capacity() * sizeof(unsigned short);
+    }
+    return bytes;
+}
+
+std::vector<unsigned> findOverlayPath(const unsigned intersect_id_start, const unsigned intersect_id_end,
+        const double right_turn_penalty, const double left_turn_penalty) {
+    static thread_local TurnSearchWorkspace workspace;
+
+    std::shared_ptr<const OverlayMetric> metric = store.cellOverlay.getMetric(right_turn_penalty, left_turn_penalty);
+    return store.cellOverlay.findPath(intersect_id_start, intersect_id_end, *metric, workspace);
+}
@@ -0,0 +1,168 @@
+/* Multi level cell overlay over the turn graph, customizable route planning
+ * Intersections are split by recursive geometric bisection into nested cells, the cells of a level are unions of
+ * cells of the level below. A directed segment belongs to the cell of the intersection it ends at, so the segments
+ * crossing a cell boundary are the entries of the cell they enter and the exits of the cell they leave
+ * Preprocessing finds the cells, their entries and exits and an order to remove the nodes inside each cell, none of
+ * which depends on the turn penalties
+ * Customizing a penalty pair fills one shortcut cost per entry and exit of every cell, the cheapest way through the
+ * cell, by removing the nodes inside the cell in that order. Levels go from the finest, in parallel over the cells
+ * A query searches the turn graph in the cells of its endpoints and the coarsest shortcuts everywhere else, then
+ * unpacks each shortcut with a search inside its cell
+ */
+
+#ifndef CELLOVERLAY_H
+#define CELLOVERLAY_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "TurnGraph.h"
+#include "SearchStats.h"
+
+// Largest number of intersections in a cell of the finest level
+// Customizing a level costs more the bigger its cells, small cells keep a new penalty pair well under a second
+#define OVERLAY_CELL_SIZE 32
+
+// Bisections between two levels, each cell is split into 2^OVERLAY_LEVEL_BISECTIONS cells of the level below
+#define OVERLAY_LEVEL_BISECTIONS 2
+
+// Most levels above the turn graph, levels with a single cell are left out
+#define OVERLAY_MAX_LEVELS 2
+
+// Overlay metrics kept for the most recently used penalty pairs
+#define OVERLAY_METRIC_CACHE_SIZE 4
+
+// Not an entry of any cell at a level
+#define NO_ENTRY ((unsigned)-1)
+
+// Cells of one overlay level, entries and exits are directed segments listed by cell
+struct OverlayLevel {
+    unsigned cellCount = 0;
+    std::vector<unsigned> cells;
+
+    // Entries of cell c are entries[entryOffsets[c], entryOffsets[c + 1]), exits the same
+    std::vector<unsigned> entryOffsets;
+    std::vector<unsigned> entries;
+    std::vector<unsigned> exitOffsets;
+    std::vector<unsigned> exits;
+
+    // Position of each directed segment among the entries of its cell, NO_ENTRY if it is not one
+    std::vector<unsigned> entryIndices;
+
+    // Shortcuts of cell c are a row per entry and a column per exit, starting at shortcutOffsets[c]
+    std::vector<unsigned> shortcutOffsets;
+
+    /* Customization graph of every cell, numbered from 0 within the cell
+     * The nodes of cell c are [nodeOffsets[c], nodeOffsets[c + 1]), the directed segments ending in c at level 1 and the
+     * entries of the cells below above it, then the exits of c in the order of exits
+     * Node n leads to targets[targetOffsets[targetLists[n]], targetOffsets[targetLists[n] + 1]) at the costs of the
+     * level below from costOffsets[n] on, the entries of one cell below share its exits as their list
+     */
+    std::vector<unsigned> nodeOffsets;
+    std::vector<unsigned> targetLists;
+    std::vector<unsigned> targetOffsets;
+    std::vector<unsigned> targets;
+    std::vector<unsigned> costOffsets;
+    unsigned maxCellNodes = 0;
+
+    // Node of each entry in its cell, by position in entries
+    std::vector<unsigned> entryNodes;
+
+    /* Entries of a cell are never reached and its exits never left, so removing every other node in turn, and joining
+     * each of its predecessors to each of its successors, leaves the cheapest cost from every entry to every exit
+     * Cell c removes eliminated[s] for the steps s in [eliminationOffsets[c], eliminationOffsets[c + 1]), joining
+     * neighbours[neighbourOffsets[s], neighbourOffsets[s] + predecessorCounts[s]) to the rest up to neighbourOffsets[s + 1]
+     * Neighbours are most of the overlay's memory, a cell of the coarsest level has a few hundred nodes
+     */
+    std::vector<unsigned> eliminationOffsets;
+    std::vector<unsigned> eliminated;
+    std::vector<unsigned> neighbourOffsets;
+    std::vector<unsigned> predecessorCounts;
+    std::vector<unsigned short> neighbours;
+};
+
+// Turn graph arc costs and shortcut costs of every level for one pair of turn penalties
+struct OverlayMetric {
+    std::shared_ptr<const TurnMetric> turnMetric;
+    std::vector<std::vector<double>> shortcutCosts;
+
+    // Wall time of the customization in ms
+    double customizationTime = 0;
+};
+
+class CellOverlay {
+public:
+    // Partitions the intersections and builds the cells and their elimination orders, needs store.turnGraph and its arcs built
+    void build();
+    void clear();
+
+    // Shortcut costs for a penalty pair, customized on first use and cached
+    std::shared_ptr<const OverlayMetric> getMetric(double rightTurnPenalty, double leftTurnPenalty);
+    OverlayMetric customize(double rightTurnPenalty, double leftTurnPenalty) const;
+
+    /* A* over the turn graph near the endpoints and the shortcuts in between
+     * @params intersection from, intersection to, metric, workspace of the calling thread
+     * @returns segments of the cheapest path by compute_path_travel_time, empty if there is none
+     */
+    std::vector<unsigned> findPath(unsigned from, unsigned to, const OverlayMetric& metric, TurnSearchWorkspace& workspace) const;
+
+    // Getters
+    unsigned getLevelCount() const;
+    unsigned getCellCount(unsigned level) const;
+    unsigned getCell(unsigned level, unsigned intersection) const;
+    unsigned getShortcutCount() const;
+    std::size_t getMemoryUsage() const;
+
+private:
+    // Overlay level l is levels[l - 1], level 0 is the turn graph
+    std::vector<OverlayLevel> levels;
+    unsigned intersectionCount = 0;
+    unsigned shortcutCount = 0;
+
+    // Most recently used metric last
+    std::vector<std::shared_ptr<const OverlayMetric>> metrics;
+    std::mutex metricsMutex;
+
+    void partition();
+    void findBoundaries(OverlayLevel& level);
+    void buildCellGraphs(unsigned level);
+
+    // Orders the removal of the nodes of a cell, each time the node that adds the fewest joins
+    void orderEliminations(OverlayLevel& cells, unsigned cell) const;
+
+    /* Removes the nodes inside a cell on a matrix of costs between its nodes, then copies out its entry to exit costs
+     * @params level, cell, costs of the level below, shortcut costs of the level to fill, matrix of the calling thread
+     */
+    void customizeCell(unsigned level, unsigned cell, const std::vector<double>& belowCosts, std::vector<double>& costs,
+            std::vector<double>& matrix) const;
+
+    /* Dijkstra from an entry of a cell over the arcs of the level below, without leaving the cell
+     * Exits of the cell are reached but not searched from
+     * @params level, source entry, metric, workspace, target to stop at or NO_EDGE to search the whole cell, stats
+     * @returns generation of the search, workspace entries of that generation were reached
+     */
+    unsigned searchCell(unsigned level, unsigned source, const OverlayMetric& metric, TurnSearchWorkspace& workspace,
+            int target, SearchStats& stats) const;
+
+    // Calls reach(target, time, edge) for every arc of a level out of a directed segment reached at time
+    template <typename Reach>
+    void relaxArcs(unsigned level, unsigned edge, double time, const OverlayMetric& metric, Reach& reach) const;
+
+    // Level a query uses at a directed segment, the coarsest level whose cell holds neither endpoint
+    unsigned getQueryLevel(unsigned edge, unsigned from, unsigned to) const;
+
+    // Appends the segments of the cheapest path from source to target through the cell, source not included
+    void unpack(unsigned level, unsigned source, unsigned target, const OverlayMetric& metric,
+            TurnSearchWorkspace& workspace, SearchStats& stats, std::vector<unsigned>& path) const;
+};
+
+/* Path search backend over store.cellOverlay, exact with turn penalties like findTurnExactPath
+ * Safe to call from several threads at once, each thread keeps its own workspace
+ * @params intersect_id_start, intersect_id_end, right_turn_penalty, left_turn_penalty
+ * @returns segments of the path, empty if there is no path
+ */
+std::vector<unsigned> findOverlayPath(const unsigned intersect_id_start, const unsigned intersect_id_end,
+        const double right_turn_penalty, const double left_turn_penalty);
+
+#endif /* CELLOVERLAY_H */
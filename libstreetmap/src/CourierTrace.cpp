@@ -0,0 +1,50 @@
+#include "CourierTrace.h"
+#include "ReportUtil.h"
+
+#include <cfloat>
+
+void CourierTrace::start() {
+    improvements.clear();
+    matrixTime = 0;
+    totalTime = 0;
+    callStart = Clock::now();
+}
+
+void CourierTrace::endMatrix() {
+    matrixTime = elapsedMilliseconds(callStart);
+}
+
+void CourierTrace::finish() {
+    totalTime = elapsedMilliseconds(callStart);
+}
+
+void CourierTrace::improve(double cost) {
+    if (cost >= getBestCost()) return;
+
+    CourierImprovement improvement;
+    improvement.time = elapsedMilliseconds(callStart);
+    improvement.cost = cost;
+    improvements.push_back(improvement);
+}
+
+double CourierTrace::getMatrixTime() {
+    return matrixTime;
+}
+
+// Time after the matrix phase
+double CourierTrace::getSolveTime() {
+    return totalTime - matrixTime;
+}
+
+double CourierTrace::getTotalTime() {
+    return totalTime;
+}
+
+// DBL_MAX until a route is found
+double CourierTrace::getBestCost() {
+    return improvements.empty() ? DBL_MAX : improvements.back().cost;
+}
+
+std::vector<CourierImprovement> CourierTrace::getImprovements() {
+    return improvements;
+}
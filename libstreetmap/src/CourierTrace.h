@@ -0,0 +1,45 @@
+/* CourierTrace records where traveling_courier spends its time and how its best solution improves
+ * The call is split into the matrix phase (path times between every pickup, drop off and depot) and the
+ * solve phase, and every improvement of the best route is recorded with the time it was found, so
+ * solution cost can be plotted against wall clock time
+ */
+
+#ifndef COURIERTRACE_H
+#define COURIERTRACE_H
+
+#include <chrono>
+#include <vector>
+
+struct CourierImprovement {
+    // ms since the call started, travel time of the route in s
+    double time = 0;
+    double cost = 0;
+};
+
+class CourierTrace {
+public:
+    // Phase timers, called by traveling_courier
+    void start();
+    void endMatrix();
+    void finish();
+
+    // Records a new best route, ignored if it is not cheaper than the best so far
+    void improve(double cost);
+
+    // Getters
+    double getMatrixTime();
+    double getSolveTime();
+    double getTotalTime();
+    double getBestCost();
+    std::vector<CourierImprovement> getImprovements();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point callStart;
+    double matrixTime = 0;
+    double totalTime = 0;
+    std::vector<CourierImprovement> improvements;
+};
+
+#endif /* COURIERTRACE_H */
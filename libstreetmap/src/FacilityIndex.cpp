@@ -0,0 +1,239 @@
+#include "FacilityIndex.h"
+#include "m1.h"
+#include "Store.h"
+#include "StreetsDatabaseAPI.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+void FacilityIndex::build() {
+    clear();
+    unsigned intersectionCount = getNumIntersections();
+    unsigned poiCount = getNumPointsOfInterest();
+
+    // Projection around the mean latitude, so grid distances match find_distance_between_two_points closely
+    double latitudeSum = 0;
+    for (unsigned intersection = 0; intersection < intersectionCount; intersection++) {
+        latitudeSum += getIntersectionPosition(intersection).lat();
+    }
+    double meanLatitude = intersectionCount == 0 ? 0 : latitudeSum / intersectionCount * DEG_TO_RAD;
+    projectionScale = cos(meanLatitude);
+
+    intersectionX.resize(intersectionCount);
+    intersectionY.resize(intersectionCount);
+    double maxX = 0, maxY = 0;
+    for (unsigned intersection = 0; intersection < intersectionCount; intersection++) {
+        LatLon position = getIntersectionPosition(intersection);
+        intersectionX[intersection] = position.lon() * projectionScale * DEG_TO_RAD * EARTH_RADIUS_IN_METERS;
+        intersectionY[intersection] = position.lat() * DEG_TO_RAD * EARTH_RADIUS_IN_METERS;
+
+        if (intersection == 0 || intersectionX[intersection] < minX) minX = intersectionX[intersection];
+        if (intersection == 0 || intersectionY[intersection] < minY) minY = intersectionY[intersection];
+        if (intersection == 0 || intersectionX[intersection] > maxX) maxX = intersectionX[intersection];
+        if (intersection == 0 || intersectionY[intersection] > maxY) maxY = intersectionY[intersection];
+    }
+
+    // Square cells holding FACILITY_GRID_CELL_SIZE intersections on average, a single cell for a degenerate map
+    double area = (maxX - minX) * (maxY - minY);
+    cellSize = area > 0 ? sqrt(area / intersectionCount * FACILITY_GRID_CELL_SIZE) : std::max(std::max(maxX - minX, maxY - minY), 1.0);
+    columns = (unsigned)((maxX - minX) / cellSize) + 1;
+    rows = (unsigned)((maxY - minY) / cellSize) + 1;
+
+    // Counting sort of the intersections by cell, in id order within a cell
+    gridOffsets.assign(columns * rows + 1, 0);
+    for (unsigned intersection = 0; intersection < intersectionCount; intersection++) {
+        gridOffsets[getRow(intersectionY[intersection]) * columns + getColumn(intersectionX[intersection]) + 1]++;
+    }
+    for (unsigned cell = 0; cell < columns * rows; cell++) gridOffsets[cell + 1] += gridOffsets[cell];
+
+    gridIntersections.resize(intersectionCount);
+    std::vector<unsigned> cellFill(gridOffsets.begin(), gridOffsets.end() - 1);
+    for (unsigned intersection = 0; intersection < intersectionCount; intersection++) {
+        gridIntersections[cellFill[getRow(intersectionY[intersection]) * columns + getColumn(intersectionX[intersection])]++] = intersection;
+    }
+
+    // Snap every POI and give every type a category
+    poiCategories.resize(poiCount);
+    poiIntersections.resize(poiCount);
+    for (unsigned poi = 0; poi < poiCount; poi++) {
+        std::string type = getPointOfInterestType(poi);
+        auto category = categoryIds.find(type);
+        if (category == categoryIds.end()) {
+            category = categoryIds.emplace(type, categoryNames.size()).first;
+            categoryNames.push_back(type);
+        }
+
+        poiCategories[poi] = category->second;
+        poiIntersections[poi] = findClosestIntersection(getPointOfInterestPosition(poi));
+    }
+    if (intersectionCount == 0) return;
+
+    // Counting sort of the POIs by snapped intersection, in id order within an intersection
+    poiOffsets.assign(intersectionCount + 1, 0);
+    for (unsigned poi = 0; poi < poiCount; poi++) poiOffsets[poiIntersections[poi] + 1]++;
+    for (unsigned intersection = 0; intersection < intersectionCount; intersection++) poiOffsets[intersection + 1] += poiOffsets[intersection];
+
+    intersectionPois.resize(poiCount);
+    std::vector<unsigned> poiFill(poiOffsets.begin(), poiOffsets.end() - 1);
+    for (unsigned poi = 0; poi < poiCount; poi++) intersectionPois[poiFill[poiIntersections[poi]]++] = poi;
+
+    targetWords = (intersectionCount + 63) / 64;
+    targets.assign(categoryNames.size() * targetWords, 0);
+    for (unsigned poi = 0; poi < poiCount; poi++) {
+        targets[poiCategories[poi] * targetWords + poiIntersections[poi] / 64] |= (uint64_t)1 << (poiIntersections[poi] % 64);
+    }
+}
+
+void FacilityIndex::clear() {
+    intersectionX.clear();
+    intersectionY.clear();
+    gridOffsets.clear();
+    gridIntersections.clear();
+    columns = 0;
+    rows = 0;
+    categoryIds.clear();
+    categoryNames.clear();
+    poiCategories.clear();
+    poiIntersections.clear();
+    poiOffsets.clear();
+    intersectionPois.clear();
+    targets.clear();
+    targetWords = 0;
+}
+
+unsigned FacilityIndex::getColumn(double x) const {
+    if (x <= minX) return 0;
+    return std::min((unsigned)((x - minX) / cellSize), columns - 1);
+}
+
+unsigned FacilityIndex::getRow(double y) const {
+    if (y <= minY) return 0;
+    return std::min((unsigned)((y - minY) / cellSize), rows - 1);
+}
+
+unsigned FacilityIndex::findClosestIntersection(LatLon position) const {
+    if (intersectionX.empty()) return 0;
+
+    double x = position.lon() * projectionScale * DEG_TO_RAD * EARTH_RADIUS_IN_METERS;
+    double y = position.lat() * DEG_TO_RAD * EARTH_RADIUS_IN_METERS;
+    int column = getColumn(x);
+    int row = getRow(y);
+
+    // Rings of cells around the position's cell, every cell past ring r is at least r cells away
+    unsigned closest = 0;
+    double closestDistance = DBL_MAX;
+    int maxRing = std::max(columns, rows);
+    for (int ring = 0; ring <= maxRing; ring++) {
+        for (int cellRow = row - ring; cellRow <= row + ring; cellRow++) {
+            if (cellRow < 0 || cellRow >= (int)rows) continue;
+
+            // Inner rows of the ring only have its two edge cells
+            bool edgeRow = cellRow == row - ring || cellRow == row + ring;
+            int step = edgeRow || ring == 0 ? 1 : 2 * ring;
+            for (int cellColumn = column - ring; cellColumn <= column + ring; cellColumn += step) {
+                if (cellColumn < 0 || cellColumn >= (int)columns) continue;
+
+                unsigned cell = cellRow * columns + cellColumn;
+                for (unsigned index = gridOffsets[cell]; index < gridOffsets[cell + 1]; index++) {
+                    unsigned intersection = gridIntersections[index];
+                    double distance = (intersectionX[intersection] - x) * (intersectionX[intersection] - x)
+                            + (intersectionY[intersection] - y) * (intersectionY[intersection] - y);
+
+                    if (distance < closestDistance || (distance == closestDistance && intersection < closest)) {
+                        closestDistance = distance;
+                        closest = intersection;
+                    }
+                }
+            }
+        }
+
+        if (closestDistance <= (ring * cellSize) * (ring * cellSize)) break;
+    }
+
+    return closest;
+}
+
+std::vector<FacilityMatch> FacilityIndex::findNearest(unsigned source, int category, unsigned k, const TurnMetric& metric,
+        TurnSearchWorkspace& workspace) const {
+    std::vector<FacilityMatch> matches;
+    if (category < 0 || (unsigned)category >= categoryNames.size() || k == 0 || source + 1 >= poiOffsets.size()) return matches;
+
+    // Intersections whose POIs were taken, an intersection is settled once per directed segment ending at it
+    std::vector<unsigned> taken;
+
+    auto settle = [&](unsigned intersection, double time, int edge) {
+        if (!hasTarget(category, intersection)) return;
+        if (std::find(taken.begin(), taken.end(), intersection) != taken.end()) return;
+        taken.push_back(intersection);
+
+        std::vector<unsigned> path;
+        for (int reaching = edge; reaching != NO_EDGE; reaching = workspace.reachingEdges[reaching]) path.push_back(reaching / 2);
+        std::reverse(path.begin(), path.end());
+
+        for (unsigned index = poiOffsets[intersection]; index < poiOffsets[intersection + 1] && matches.size() < k; index++) {
+            unsigned poi = intersectionPois[index];
+            if (poiCategories[poi] == (unsigned)category) matches.push_back(FacilityMatch{poi, intersection, time, path});
+        }
+    };
+
+    settle(source, 0, NO_EDGE);
+    if (matches.size() >= k) return matches;
+
+    // Directed segments are settled by travel time, so the first one into an intersection settles the intersection
+    const TurnGraph& graph = store.turnGraph;
+    graph.searchAll(source, metric, workspace, DBL_MAX, [&](unsigned edge, double time) {
+        settle(graph.getEdgeHead(edge), time, edge);
+        return matches.size() < k;
+    });
+
+    return matches;
+}
+
+unsigned FacilityIndex::getCategoryCount() const {
+    return categoryNames.size();
+}
+
+std::string FacilityIndex::getCategoryName(unsigned category) const {
+    return categoryNames[category];
+}
+
+unsigned FacilityIndex::getSnappedIntersection(unsigned poi) const {
+    return poiIntersections[poi];
+}
+
+int FacilityIndex::getCategory(const std::string& type) const {
+    auto category = categoryIds.find(type);
+    return category == categoryIds.end() ? NO_CATEGORY : (int)category->second;
+}
+
+bool FacilityIndex::hasTarget(unsigned category, unsigned intersection) const {
+    return (targets[category * targetWords + intersection / 64] >> (intersection % 64)) & 1;
+}
+
+// Names and hash buckets of the categories are estimated
+std::size_t FacilityIndex::getMemoryUsage() const {
+    std::size_t names = 0;
+    for (const std::string& name : categoryNames) names += 2 * (sizeof(std::string) + name.capacity()) + sizeof(unsigned) + sizeof(void*);
+
+    return (intersectionX.capacity() + intersectionY.capacity()) * sizeof(double)
+            + (gridOffsets.capacity() + gridIntersections.capacity() + poiCategories.capacity() + poiIntersections.capacity()
+            + poiOffsets.capacity() + intersectionPois.capacity()) * sizeof(unsigned)
+            + targets.capacity() * sizeof(uint64_t) + names + categoryIds.bucket_count() * sizeof(void*);
+}
+
+std::vector<FacilityMatch> findNearestFacilities(const unsigned source, const std::string& type, const unsigned k,
+        const double right_turn_penalty, const double left_turn_penalty) {
+    static thread_local TurnSearchWorkspace workspace;
+
+    int category = store.facilityIndex.getCategory(type);
+    if (category == NO_CATEGORY) return std::vector<FacilityMatch>();
+
+    std::shared_ptr<const TurnMetric> metric = store.turnGraph.getMetric(right_turn_penalty, left_turn_penalty);
+    return store.facilityIndex.findNearest(source, category, k, *metric, workspace);
+}
+
+std::vector<FacilityMatch> findNearestFacilities(const LatLon position, const std::string& type, const unsigned k,
+        const double right_turn_penalty, const double left_turn_penalty) {
+    return findNearestFacilities(store.facilityIndex.findClosestIntersection(position), type, k, right_turn_penalty, left_turn_penalty);
+}
@@ -0,0 +1,115 @@
+/* Facility index, finds the points of interest of a type that are closest by travel time
+ * Every POI is snapped once per map to its closest intersection, through a uniform grid over the intersections,
+ * and every POI type gets a bitmap of the intersections that have a POI of that type snapped to them
+ * A query is one Dijkstra over store.turnGraph from the source, so times are exact with turn penalties. Every
+ * settled intersection costs one bit test, and the search stops as soon as the k closest POIs are settled
+ * Travel time is to the intersection a POI is snapped to, the last stretch off the street network is not counted
+ */
+
+#ifndef FACILITYINDEX_H
+#define FACILITYINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LatLon.h"
+#include "TurnGraph.h"
+
+// Intersections in a snapping grid cell on average
+#define FACILITY_GRID_CELL_SIZE 4
+
+// POIs returned by the /nearest command
+#define FACILITY_DEFAULT_RESULTS 5
+
+// No POI type of that name
+#define NO_CATEGORY -1
+
+struct FacilityMatch {
+    unsigned poi;
+
+    // Intersection the POI is snapped to and the travel time to it
+    unsigned intersection;
+    double travelTime;
+
+    // Segments from the source to the intersection, empty for POIs snapped to the source
+    std::vector<unsigned> path;
+};
+
+class FacilityIndex {
+public:
+    // Snaps every POI and builds the type bitmaps, needs only the streets database
+    void build();
+    void clear();
+
+    /* Closest intersection by straight line distance on the map projection, through the snapping grid
+     * @params position
+     * @returns intersection id, 0 if the map has no intersections
+     */
+    unsigned findClosestIntersection(LatLon position) const;
+
+    /* Dijkstra from an intersection that stops once the k closest POIs of a category are settled
+     * @params intersection source, category, k, metric, workspace of the calling thread
+     * @returns at most k POIs by ascending travel time, POIs at the same intersection by id, fewer if not enough are reachable
+     */
+    std::vector<FacilityMatch> findNearest(unsigned source, int category, unsigned k, const TurnMetric& metric,
+            TurnSearchWorkspace& workspace) const;
+
+    // Getters
+    unsigned getCategoryCount() const;
+    std::string getCategoryName(unsigned category) const;
+    unsigned getSnappedIntersection(unsigned poi) const;
+    std::size_t getMemoryUsage() const;
+
+    // Category of a POI type, NO_CATEGORY if no POI has that type
+    int getCategory(const std::string& type) const;
+
+    // Whether an intersection has a POI of a category snapped to it
+    bool hasTarget(unsigned category, unsigned intersection) const;
+
+private:
+    // Intersections on the equirectangular projection of find_distance_between_two_points, around the map's mean latitude
+    double projectionScale = 1;
+    std::vector<double> intersectionX;
+    std::vector<double> intersectionY;
+
+    // Intersections in grid cell (column, row) are gridIntersections[gridOffsets[c], gridOffsets[c + 1]), c = row * columns + column
+    double minX = 0;
+    double minY = 0;
+    double cellSize = 1;
+    unsigned columns = 0;
+    unsigned rows = 0;
+    std::vector<unsigned> gridOffsets;
+    std::vector<unsigned> gridIntersections;
+
+    // POI types, and the category and snapped intersection of every POI
+    std::unordered_map<std::string, unsigned> categoryIds;
+    std::vector<std::string> categoryNames;
+    std::vector<unsigned> poiCategories;
+    std::vector<unsigned> poiIntersections;
+
+    // POIs snapped to intersection i are intersectionPois[poiOffsets[i], poiOffsets[i + 1]), ascending ids
+    std::vector<unsigned> poiOffsets;
+    std::vector<unsigned> intersectionPois;
+
+    // Bit i % 64 of targets[category * targetWords + i / 64] is set if intersection i has a POI of that category
+    std::vector<uint64_t> targets;
+    unsigned targetWords = 0;
+
+    // Grid cell of a projected point, clamped to the grid
+    unsigned getColumn(double x) const;
+    unsigned getRow(double y) const;
+};
+
+/* k closest POIs of a type by travel time, over store.facilityIndex and store.turnGraph
+ * Safe to call from several threads at once, each thread keeps its own workspace
+ * @params intersection source or a position snapped to its closest intersection, POI type, k, right_turn_penalty, left_turn_penalty
+ * @returns at most k POIs by ascending travel time, empty if no POI has that type
+ */
+std::vector<FacilityMatch> findNearestFacilities(const unsigned source, const std::string& type, const unsigned k,
+        const double right_turn_penalty, const double left_turn_penalty);
+std::vector<FacilityMatch> findNearestFacilities(const LatLon position, const std::string& type, const unsigned k,
+        const double right_turn_penalty, const double left_turn_penalty);
+
+#endif /* FACILITYINDEX_H */
@@ -20,13 +20,13 @@ void searchHandler(ezgl::application *application) {
     }
     
     // route command
-    if (store.searchString.find("route ") != std::string::npos) routeHandler("route ");
+    if (store.searchString.find("route ") != std::string::npos) routeHandler("route ", application);
     // find intersection command
     //else if (store.SEARCH_STRING.find(" & ") != std::string::npos) intersectionHandler(" & ", application);
     // switch map command w/ city & country
     else if (store.searchString.find(", ") != std::string::npos) { 
-        mapChangeCityHandler(", ");
-        application->quit();
+        if (mapChangeCityHandler(", ")) application->quit();
+        else errorHandler(application, "Map not found");
     // enable networking command
     } else if (store.searchString.find("/network") != std::string::npos){
         store.networkingFlag = true;
@@ -43,16 +43,25 @@ void searchHandler(ezgl::application *application) {
     // get help command
     } else if (store.searchString.find("/help") != std::string::npos) {
         helpHandler(application);
+    // render profiler command
+    } else if (store.searchString.find("/profile") != std::string::npos) {
+        profileHandler(application);
+    // reachability area command
+    } else if (store.searchString.find("/isochrone") != std::string::npos) {
+        isochroneHandler(application, "/isochrone");
+    // closest POIs by travel time command
+    } else if (store.searchString.find("/nearest") != std::string::npos) {
+        nearestHandler(application, "/nearest");
     // search string is taken as a POI, if POI does not exist, taken that input was 
-    // map country name
+    // map country name, if no such map exists, the closest POI and street names are suggested
     } else if (store.searchString.find(" & ") != std::string::npos) {
         streetIntersectionHandler(" & ", application);
     }
     else {
         if(!poiHandler(application)) {
             if(!intersectionHandler(application)){
-                mapChangeCountryHandler();
-                application->quit();
+                if (mapChangeCountryHandler()) application->quit();
+                else if (!fuzzyHandler(application)) errorHandler(application, "No results found");
             }
         }
     }
@@ -61,7 +70,7 @@ void searchHandler(ezgl::application *application) {
   
 }
 
-void routeHandler(std::string delimiter) {
+void routeHandler(std::string delimiter, ezgl::application *application) {
     // Get route number from search
     std::string routeNum = store.searchString.substr(store.searchString.find(delimiter) + delimiter.size(), store.searchString.length());
     
@@ -71,7 +80,10 @@ void routeHandler(std::string delimiter) {
         store.focusedRoute = std::stoi(routeNum);
         
         // Build only if not already cached
-        if (!store.routes.find(std::stoi(routeNum))->second->alreadyBuilt) buildBusStops(std::stoi(routeNum));
+        // Redraws once the stops arrive
+        if (!store.routes.find(std::stoi(routeNum))->second->alreadyBuilt) {
+            buildBusStops(std::stoi(routeNum), [application]() { application->refresh_drawing(); });
+        }
     }
 }
 
@@ -149,7 +161,10 @@ bool intersectionHandler(ezgl::application *application){
     return true;
 }
 
-void mapChangeCountryHandler() {
+/* Handler for map changes by country name, returns false if there is no such map
+ * Return is to be used for search handling
+ */
+bool mapChangeCountryHandler() {
     std::string mapName = ""; 
     std::vector<std::string> countryNameSplit;
     boost::split(countryNameSplit, store.searchString, boost::is_any_of(" "));
@@ -160,12 +175,60 @@ void mapChangeCountryHandler() {
         mapName.append("-");
     }
     mapName.append(countryNameSplit[countryNameSplit.size() - 1]); 
+    
+    if (!mapExists(mapName)) return false;
 
     // Prepare store for restart
     store.prevMap = store.mapName;
     store.mapName = mapName;
     store.reloadFlag = true;
     store.resetStore();
+    
+    return true;
+}
+
+/* Handler for mistyped searches, suggests the POI and street names within a few edits of the search
+ * The closest POIs are highlighted if a POI is the best match
+ * Return is false if nothing is close enough, to be used for search handling
+ */
+bool fuzzyHandler(ezgl::application *application) {
+    std::string query = store.searchString;
+    if (query.length() < FUZZY_MIN_QUERY_LENGTH) return false;
+    
+    unsigned maxDistance = query.length() < FUZZY_LONG_QUERY_LENGTH ? 1 : 2;
+    std::vector<FuzzyMatch> pois = store.NAME_INDEX.findFuzzy(query, POI_ENTITY, maxDistance, FUZZY_MAX_RESULTS);
+    std::vector<FuzzyMatch> streets = store.NAME_INDEX.findFuzzy(query, STREET_ENTITY, maxDistance, FUZZY_MAX_RESULTS);
+    
+    if (pois.empty() && streets.empty()) return false;
+    
+    // Merge both rankings by distance, POIs first on ties
+    std::vector<std::string> suggestions;
+    auto poi = pois.begin();
+    auto street = streets.begin();
+    while (suggestions.size() < FUZZY_MAX_RESULTS && (poi != pois.end() || street != streets.end())) {
+        if (street == streets.end() || (poi != pois.end() && poi->distance <= street->distance)) {
+            suggestions.push_back(getPointOfInterestName(poi->ids.front()) + " (POI)");
+            poi++;
+        } else {
+            suggestions.push_back(getStreetName(street->ids.front()) + " (street)");
+            street++;
+        }
+    }
+    
+    application->createSuggestionCard(store.searchString, suggestions);
+    
+    if (pois.empty() || (!streets.empty() && streets.front().distance < pois.front().distance)) return true;
+    
+    store.highlightedPOIs = pois.front().ids;
+    
+    // Zoom fit routine to visualize all the highlights
+    std::string main_canvas_id = application->get_main_canvas_id();
+    auto canvas = application->get_canvas(main_canvas_id);
+    store.zoomLevel = 1;
+    ezgl::zoom_fit(canvas, canvas->get_camera().get_initial_world());
+    ezgl::zoom_in(canvas, DEFAULT_ZOOM_SCALE);
+    
+    return true;
 }
 
 /* Handlers for poi, return false if the poi is not found
@@ -177,18 +240,12 @@ bool poiHandler(ezgl::application *application){
     
     if (poiName.length() == 0) { return true; }
     
-    std::transform(poiName.begin(), poiName.end(), poiName.begin(), ::tolower);
-    
-    auto pointsOfInterests = store.POI_DICTIONARY.equal_range(poiName);
-    if (pointsOfInterests.first == pointsOfInterests.second) {
+    store.highlightedPOIs = store.NAME_INDEX.findExact(poiName, POI_ENTITY);
+    if (store.highlightedPOIs.empty()) {
         errorHandler(application, "Did not find POI");
         return false;
     }
     
-    for (auto it = pointsOfInterests.first; it != pointsOfInterests.second; it++) {
-        store.highlightedPOIs.push_back(it->second);
-    }
-    
     // Zoom fit routine to visualize all the highlights
     std::string main_canvas_id = application->get_main_canvas_id();
     auto canvas = application->get_canvas(main_canvas_id);
@@ -245,7 +302,9 @@ void clickHandler(ezgl::application *application, double &x, double &y) {
 }
    
 
-void mapChangeCityHandler(std::string delimiter) {
+/* Handler for map changes by city and country, returns false if there is no such map
+ */
+bool mapChangeCityHandler(std::string delimiter) {
     // Get city and country from search string
     std::string city = store.searchString.substr(0, store.searchString.find(delimiter));
     std::string country = store.searchString.substr(store.searchString.find(delimiter) + delimiter.size(), store.searchString.length());
@@ -265,97 +324,101 @@ void mapChangeCityHandler(std::string delimiter) {
     mapName.append("_");
     mapName.append(country);
     
+    if (!mapExists(mapName)) return false;
+    
     // Prepare store for map reload
     store.prevMap = store.mapName;
     store.mapName = mapName;
     store.reloadFlag = true;
     store.resetStore();
+    
+    return true;
 }
 
+/* Shows a weather card for cityName once the weather API responds
+ * Responses are cached for WEATHER_TTL, so repeated commands do not hit the API
+ * @params ezgl::application pointer, cityName
+ * @returns void
+ */
 void weatherHandler(ezgl::application *application, std::string cityName) {
-    using namespace boost::property_tree;
-    ptree propertyTree;
-    application->resetCards();
-    std::string temperature, weather, lastupdate, visibility;
-
-    CURL *curlHandle = curl_easy_init();
-    store.responseBuffer = "";
-    
-    // Construct headers
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, "Accept: application/xml");
-    headers = curl_slist_append(headers, "charset: utf-8");
-
     std::string url = "http://api.openweathermap.org/data/2.5/weather/?q=" + cityName + "&mode=xml&units=metric&appid=5fd5ca6dd1c3bf49577dc13781a96b43";
     
-    curl_easy_setopt(curlHandle, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curlHandle, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, curl_write);  
-    
-    curl_easy_perform(curlHandle);
-    curl_slist_free_all(headers);
-    
-    std::istringstream inputStream(store.responseBuffer);
-    read_xml(inputStream, propertyTree);
-    
-    // Loop through each children of "current" parent
-    BOOST_FOREACH(ptree::value_type const &value, propertyTree.get_child("current")) {
-        if (value.first == "temperature") {
-            temperature = value.second.get("<xmlattr>.value", "Error: Did not get temp");
-        } else if (value.first == "weather") {
-            weather = value.second.get("<xmlattr>.value", "Error: Did not get weather");
-        } else if (value.first == "lastupdate") {
-            lastupdate = value.second.get("<xmlattr>.value", "Error: Did not get last update stamp");
-        } else if (value.first == "visibility") {
-            int rawVisibility = std::stoi(value.second.get("<xmlattr>.value", "Error: Did not get visibility"));
-            visibility = std::to_string(rawVisibility / 1000);
+    store.httpClient.get(url, WEATHER_TTL, [application, cityName](const HttpResponse& response) {
+        using namespace boost::property_tree;
+        ptree propertyTree;
+        std::string temperature, weather, lastupdate, visibility;
+        
+        if (!response.success) {
+            errorHandler(application, "Could not get the weather");
+            return;
         }
-    }
-  
-    curl_easy_cleanup(curlHandle);
-    
-    // Create weather card
-    application->createWeatherCard(cityName, weather, temperature, visibility);
-}
-
-void busPredictionHandler(ezgl::application *application) {
-    using namespace boost::property_tree;
-    ptree propertyTree;
-    
-    std::string text = "";
-    application->resetCards();
+        
+        try {
+            std::istringstream inputStream(response.body);
+            read_xml(inputStream, propertyTree);
 
-    CURL *curlHandle = curl_easy_init();
-    store.responseBuffer = "";
+            // Loop through each children of "current" parent
+            BOOST_FOREACH(ptree::value_type const &value, propertyTree.get_child("current")) {
+                if (value.first == "temperature") {
+                    temperature = value.second.get("<xmlattr>.value", "Error: Did not get temp");
+                } else if (value.first == "weather") {
+                    weather = value.second.get("<xmlattr>.value", "Error: Did not get weather");
+                } else if (value.first == "lastupdate") {
+                    lastupdate = value.second.get("<xmlattr>.value", "Error: Did not get last update stamp");
+                } else if (value.first == "visibility") {
+                    int rawVisibility = std::stoi(value.second.get("<xmlattr>.value", "Error: Did not get visibility"));
+                    visibility = std::to_string(rawVisibility / 1000);
+                }
+            }
+        } catch (const std::exception&) {
+            errorHandler(application, "Could not read the weather");
+            return;
+        }
 
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, "Accept: application/xml");
-    headers = curl_slist_append(headers, "charset: utf-8");
+        // Create weather card
+        application->resetCards();
+        application->createWeatherCard(cityName, weather, temperature, visibility);
+    }, getXMLRequestHeaders());
+}
 
+/* Shows the arrival predictions of the focused bus stop once the nextBus API responds
+ * The stop is highlighted right away, the cards follow with the response
+ * @params ezgl::application pointer
+ * @returns void
+ */
+void busPredictionHandler(ezgl::application *application) {
     std::string url = "http://webservices.nextbus.com/service/publicXMLFeed?command=predictions&a=ttc&stopId=" + std::to_string(store.focusedBusStop) + "&terse";
 
-    curl_easy_setopt(curlHandle, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curlHandle, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, curl_write);  
-
-    curl_easy_perform(curlHandle);
-    curl_slist_free_all(headers);
-
-    std::istringstream inputStream(store.responseBuffer);
-    read_xml(inputStream, propertyTree);
-
-    BOOST_FOREACH(ptree::value_type const &direction, propertyTree.get_child("body").get_child("predictions")) {
-        if (direction.first == "direction") {
-            std::string routeName = direction.second.get("<xmlattr>.title", "<unknown>");
-            BOOST_FOREACH(ptree::value_type const &prediction, direction.second) {
-                if (prediction.first == "prediction") {
-                    std::string minutes = prediction.second.get("<xmlattr>.minutes", "-1");
-                    std::string branch = prediction.second.get("<xmlattr>.branch", "-1");
-                    application->createPredictionCard(minutes, routeName, branch);
+    store.httpClient.get(url, BUS_PREDICTIONS_TTL, [application](const HttpResponse& response) {
+        using namespace boost::property_tree;
+        ptree propertyTree;
+        
+        if (!response.success) {
+            errorHandler(application, "Could not get bus predictions");
+            return;
+        }
+        
+        try {
+            std::istringstream inputStream(response.body);
+            read_xml(inputStream, propertyTree);
+            
+            application->resetCards();
+            BOOST_FOREACH(ptree::value_type const &direction, propertyTree.get_child("body").get_child("predictions")) {
+                if (direction.first == "direction") {
+                    std::string routeName = direction.second.get("<xmlattr>.title", "<unknown>");
+                    BOOST_FOREACH(ptree::value_type const &prediction, direction.second) {
+                        if (prediction.first == "prediction") {
+                            std::string minutes = prediction.second.get("<xmlattr>.minutes", "-1");
+                            std::string branch = prediction.second.get("<xmlattr>.branch", "-1");
+                            application->createPredictionCard(minutes, routeName, branch);
+                        }
+                    }
                 }
             }
+        } catch (const std::exception&) {
+            errorHandler(application, "Could not read bus predictions");
         }
-    }
+    }, getXMLRequestHeaders());
    
     application->refresh_drawing();
 }
@@ -532,11 +595,113 @@ void searchPathHandler(ezgl::application *application, std::string delimiter){
     
 
     if (foundCommon) { 
-        store.path = find_path_between_intersections(startID, endID, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        store.path = findCachedPath(startID, endID, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
         store.drawPath = true;
         pathHandler(application, store.path);
         application->refresh_drawing();
     } else {
         errorHandler(application, "Streets do not intersect, can not find path");
     }
-}
\ No newline at end of file
+}
+
+/* Handler for the render profiler, "/profile" toggles profiling, and "/profile csv"
+ * dumps the recorded frames to render_profile.csv in the working directory
+ * @params ezgl::application pointer
+ * @returns void
+ */
+void profileHandler(ezgl::application *application) {
+    if (store.searchString.find("csv") != std::string::npos) {
+        if (store.renderProfiler.writeCSV("render_profile.csv")) {
+            application->update_status("Wrote " + std::to_string(store.renderProfiler.getFrameCount()) + " frames to render_profile.csv");
+        } else {
+            errorHandler(application, "Could not write render_profile.csv");
+        }
+        return;
+    }
+    
+    store.profilingFlag = !store.profilingFlag;
+    store.renderProfiler.reset();
+    application->update_status(store.profilingFlag ? "Render profiling enabled" : "Render profiling disabled");
+}
+
+/* Draws what can be reached within the given minutes from the highlighted or last CTRL-clicked intersection
+ * Uses the turn penalties of path finding, and clears the overlay when no minutes are given
+ * @params ezgl::application pointer, delimiter of the command
+ * @returns void
+ */
+void isochroneHandler(ezgl::application *application, std::string delimiter) {
+    std::string argument = store.searchString.substr(store.searchString.find(delimiter) + delimiter.size());
+    boost::algorithm::trim(argument);
+
+    if (argument.empty()) {
+        store.drawIsochrone = false;
+        store.isochrone = Isochrone();
+        application->update_status("Isochrone cleared");
+        return;
+    }
+
+    // The whole argument must be a finite, positive number, "5abc" is rejected rather than read as 5
+    double minutes = 0;
+    std::size_t parsed = 0;
+    try {
+        minutes = std::stod(argument, &parsed);
+    } catch (const std::exception&) {
+        parsed = 0;
+    }
+    if (parsed == 0 || parsed != argument.size() || !std::isfinite(minutes) || minutes <= 0) {
+        errorHandler(application, "Invalid number of minutes");
+        return;
+    }
+
+    unsigned source;
+    if (!store.highlightedIntersections.empty()) source = store.highlightedIntersections.front();
+    else if (!store.clicked.empty()) source = store.clicked.back();
+    else {
+        errorHandler(application, "Select an intersection first");
+        return;
+    }
+
+    store.isochrone = findIsochrone(source, minutes * 60, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+    store.drawIsochrone = true;
+    application->update_status(std::to_string(store.isochrone.intersections.size()) + " intersections and "
+            + std::to_string(store.isochrone.segments.size()) + " segments within " + argument + " min of " + getIntersectionName(source));
+}
+
+/* Highlights the POIs of a type closest by travel time to the highlighted or last CTRL-clicked intersection,
+ * and draws the path to the closest one
+ * @params ezgl::application pointer, delimiter of the command
+ * @returns void
+ */
+void nearestHandler(ezgl::application *application, std::string delimiter) {
+    std::string type = store.searchString.substr(store.searchString.find(delimiter) + delimiter.size());
+    boost::algorithm::trim(type);
+
+    if (store.facilityIndex.getCategory(type) == NO_CATEGORY) {
+        errorHandler(application, "No points of interest of type " + type);
+        return;
+    }
+
+    unsigned source;
+    if (!store.highlightedIntersections.empty()) source = store.highlightedIntersections.front();
+    else if (!store.clicked.empty()) source = store.clicked.back();
+    else {
+        errorHandler(application, "Select an intersection first");
+        return;
+    }
+
+    std::vector<FacilityMatch> matches = findNearestFacilities(source, type, FACILITY_DEFAULT_RESULTS, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+    if (matches.empty()) {
+        errorHandler(application, "No " + type + " reachable from " + getIntersectionName(source));
+        return;
+    }
+
+    store.highlightedPOIs.clear();
+    for (auto match = matches.begin(); match != matches.end(); match++) store.highlightedPOIs.push_back(match->poi);
+
+    store.path = matches.front().path;
+    store.drawPath = true;
+    // An empty path means the closest one is at the source, there are no directions to give
+    if (!store.path.empty()) pathHandler(application, store.path);
+    application->update_status("Closest " + type + ": " + getPointOfInterestName(matches.front().poi) + ", "
+            + std::to_string((int)std::ceil(matches.front().travelTime / 60)) + " min away");
+}
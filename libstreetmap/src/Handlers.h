@@ -10,6 +10,7 @@
 
 #include <string>
 #include <cctype>
+#include <cmath>
 #include <ezgl/application.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -26,16 +27,20 @@ void weatherHandler(ezgl::application *application, std::string cityName);
 void pathHandler(ezgl::application *application, std::vector<unsigned> &path);
 
 // Handlers for search
-void routeHandler(std::string delimiter);
+void routeHandler(std::string delimiter, ezgl::application *application);
 void streetIntersectionHandler(std::string delimiter, ezgl::application *application);
 bool intersectionHandler (ezgl::application *application);
-void mapChangeCityHandler(std::string delimiter);
-void mapChangeCountryHandler();
+bool mapChangeCityHandler(std::string delimiter);
+bool mapChangeCountryHandler();
 bool poiHandler(ezgl::application *application);
+bool fuzzyHandler(ezgl::application *application);
 void busPredictionHandler(ezgl::application *application);
 void helpHandler(ezgl::application *application);
 void errorHandler(ezgl::application *application, std::string errorMessage);
 void searchPathHandler(ezgl::application *application, std::string delimiter);
+void profileHandler(ezgl::application *application);
+void isochroneHandler(ezgl::application *application, std::string delimiter);
+void nearestHandler(ezgl::application *application, std::string delimiter);
 
 #endif /* HANDLERS_H */
 
@@ -0,0 +1,229 @@
+#include "HttpClient.h"
+
+#include <curl/curl.h>
+
+// libcurl write callback into the std::string passed as CURLOPT_WRITEDATA
+static size_t writeBody(void *ptr, size_t size, size_t nmemb, void *stream) {
+    static_cast<std::string*>(stream)->append((char*)ptr, size * nmemb);
+    return size * nmemb;
+}
+
+HttpClient::~HttpClient() {
+    stop();
+}
+
+void HttpClient::get(std::string url, double ttl, HttpCallback callback, std::vector<std::string> headers) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Fresh enough cached responses skip the worker entirely
+    auto entry = cache.find(url);
+    if (ttl > 0 && entry != cache.end()
+            && std::chrono::duration<double>(Clock::now() - entry->second.fetched).count() < ttl) {
+        HttpResponse response = entry->second.response;
+        response.cached = true;
+
+        lock.unlock();
+        callback(response);
+        return;
+    }
+
+    Request request;
+    request.url = url;
+    request.ttl = ttl;
+    request.headers = headers;
+    request.callback = callback;
+    request.generation = generation;
+    queued.push_back(request);
+
+    // Worker is started on the first request, and again after stop
+    if (!running) {
+        stopping = false;
+        running = true;
+        worker = std::thread(&HttpClient::run, this);
+    }
+    requestCondition.notify_one();
+}
+
+unsigned HttpClient::deliver() {
+    std::vector<std::pair<Request, HttpResponse>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(completed);
+    }
+
+    for (auto request = ready.begin(); request != ready.end(); request++) {
+        request->first.callback(request->second);
+    }
+
+    return ready.size();
+}
+
+void HttpClient::cancelAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    generation++;
+    queued.clear();
+    completed.clear();
+}
+
+void HttpClient::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        stopping = true;
+    }
+    requestCondition.notify_one();
+    worker.join();
+
+    // Transfers in flight were aborted, queued requests are kept for the next worker
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+    inFlight = 0;
+}
+
+void HttpClient::setNotify(std::function<void()> notifyFunction) {
+    std::lock_guard<std::mutex> lock(mutex);
+    notify = notifyFunction;
+}
+
+void HttpClient::setStandIn(HttpStandIn standInBackend) {
+    std::lock_guard<std::mutex> lock(mutex);
+    standIn = standInBackend;
+}
+
+void HttpClient::clearCache() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cache.clear();
+}
+
+// Requests whose callback has not run yet
+unsigned HttpClient::getPendingCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queued.size() + inFlight + completed.size();
+}
+
+/* Worker loop, adds queued requests to the multi handle and collects finished transfers
+ * Sleeps on requestCondition while there is nothing in flight
+ * @params none
+ * @returns void
+ */
+void HttpClient::run() {
+    struct Transfer {
+        Request request;
+        std::string body;
+        struct curl_slist *headers = NULL;
+    };
+
+    CURLM *multiHandle = curl_multi_init();
+    std::unordered_map<CURL*, Transfer*> transfers;
+
+    while (true) {
+        std::vector<Request> started;
+        HttpStandIn backend;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (transfers.empty()) requestCondition.wait(lock, [this]() { return stopping || !queued.empty(); });
+            if (stopping) break;
+
+            started.assign(queued.begin(), queued.end());
+            queued.clear();
+            inFlight += started.size();
+            backend = standIn;
+        }
+
+        for (auto request = started.begin(); request != started.end(); request++) {
+            // Stand-in answers in place, without touching curl
+            if (backend) {
+                HttpResponse response;
+                try {
+                    response = backend(request->url);
+                } catch (...) {
+                    response = HttpResponse();
+                    response.error = "stand-in backend failed";
+                }
+                complete(*request, response);
+                continue;
+            }
+
+            Transfer *transfer = new Transfer();
+            transfer->request = *request;
+            for (auto header = request->headers.begin(); header != request->headers.end(); header++) {
+                transfer->headers = curl_slist_append(transfer->headers, header->c_str());
+            }
+
+            CURL *curlHandle = curl_easy_init();
+            curl_easy_setopt(curlHandle, CURLOPT_URL, request->url.c_str());
+            curl_easy_setopt(curlHandle, CURLOPT_HTTPHEADER, transfer->headers);
+            curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, writeBody);
+            curl_easy_setopt(curlHandle, CURLOPT_WRITEDATA, &transfer->body);
+            curl_easy_setopt(curlHandle, CURLOPT_TIMEOUT_MS, (long)HTTP_TIMEOUT);
+            curl_easy_setopt(curlHandle, CURLOPT_NOSIGNAL, 1L);
+
+            curl_multi_add_handle(multiHandle, curlHandle);
+            transfers[curlHandle] = transfer;
+        }
+
+        if (transfers.empty()) continue;
+
+        int runningCount = 0;
+        curl_multi_perform(multiHandle, &runningCount);
+
+        // Collect every finished transfer
+        int messageCount = 0;
+        CURLMsg *message;
+        while ((message = curl_multi_info_read(multiHandle, &messageCount)) != NULL) {
+            if (message->msg != CURLMSG_DONE) continue;
+
+            CURL *curlHandle = message->easy_handle;
+            Transfer *transfer = transfers[curlHandle];
+            transfers.erase(curlHandle);
+
+            HttpResponse response;
+            curl_easy_getinfo(curlHandle, CURLINFO_RESPONSE_CODE, &response.status);
+            response.success = message->data.result == CURLE_OK && response.status >= 200 && response.status < 300;
+            if (message->data.result != CURLE_OK) response.error = curl_easy_strerror(message->data.result);
+            else if (!response.success) response.error = "HTTP " + std::to_string(response.status);
+            response.body.swap(transfer->body);
+
+            curl_multi_remove_handle(multiHandle, curlHandle);
+            curl_easy_cleanup(curlHandle);
+            curl_slist_free_all(transfer->headers);
+
+            complete(transfer->request, response);
+            delete transfer;
+        }
+
+        // Wait for socket activity, bounded so new requests are picked up
+        if (!transfers.empty()) curl_multi_wait(multiHandle, NULL, 0, HTTP_POLL_INTERVAL, NULL);
+    }
+
+    // Abort whatever is still in flight
+    for (auto transfer = transfers.begin(); transfer != transfers.end(); transfer++) {
+        curl_multi_remove_handle(multiHandle, transfer->first);
+        curl_easy_cleanup(transfer->first);
+        curl_slist_free_all(transfer->second->headers);
+        delete transfer->second;
+    }
+    curl_multi_cleanup(multiHandle);
+}
+
+// Caches a finished request and queues its callback for deliver(), unless it was cancelled
+void HttpClient::complete(Request request, HttpResponse response) {
+    std::function<void()> notifyFunction;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight--;
+
+        if (response.success && request.ttl > 0) {
+            CacheEntry entry;
+            entry.fetched = Clock::now();
+            entry.response = response;
+            cache[request.url] = entry;
+        }
+
+        if (request.generation != generation) return;
+        completed.push_back(std::make_pair(request, response));
+        notifyFunction = notify;
+    }
+
+    if (notifyFunction) notifyFunction();
+}
@@ -0,0 +1,107 @@
+/* HttpClient fetches URLs on a worker thread that drives a curl multi handle, so network commands never block the GUI
+ * Every request has its own buffer, and responses are cached by URL for the TTL the caller asks for
+ * Callbacks are not run on the worker: completed requests wait until deliver() is called, which the GUI
+ * schedules on the GTK main loop through the notify hook. A stand-in backend can replace curl for testing
+ */
+
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Request limits in ms
+#define HTTP_TIMEOUT 10000
+#define HTTP_POLL_INTERVAL 50
+
+struct HttpResponse {
+    bool success = false;
+    long status = 0;
+    std::string body;
+    std::string error;
+
+    // Whether the response came from the cache rather than the network
+    bool cached = false;
+};
+
+typedef std::function<void(const HttpResponse& response)> HttpCallback;
+
+// Answers a request in place of the network, runs on the worker thread
+typedef std::function<HttpResponse(const std::string& url)> HttpStandIn;
+
+class HttpClient {
+public:
+    ~HttpClient();
+
+    /* Fetches url in the background, callback is run by deliver() once the response arrives
+     * A successful response younger than ttl seconds is reused without a request, 0 always fetches
+     */
+    void get(std::string url, double ttl, HttpCallback callback, std::vector<std::string> headers = std::vector<std::string>());
+
+    // Runs the callbacks of every completed request on the calling thread, returns how many ran
+    unsigned deliver();
+
+    // Drops the callbacks of pending and undelivered requests, requests in flight still fill the cache
+    void cancelAll();
+
+    // Stops the worker thread, to be called before curl_global_cleanup
+    void stop();
+
+    // Setters
+    // Called from the worker whenever a response is waiting for deliver(), must be thread safe
+    void setNotify(std::function<void()> notify);
+
+    // Replaces the curl backend, an empty stand-in restores it
+    void setStandIn(HttpStandIn standIn);
+
+    void clearCache();
+
+    // Getters
+    unsigned getPendingCount();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Request {
+        std::string url;
+        double ttl = 0;
+        std::vector<std::string> headers;
+        HttpCallback callback;
+
+        // Callbacks of requests cancelled by cancelAll are dropped, the response still fills the cache
+        unsigned generation = 0;
+    };
+
+    struct CacheEntry {
+        Clock::time_point fetched;
+        HttpResponse response;
+    };
+
+    std::thread worker;
+    bool running = false;
+    std::atomic<bool> stopping{false};
+
+    std::mutex mutex;
+    std::condition_variable requestCondition;
+    std::deque<Request> queued;
+    std::vector<std::pair<Request, HttpResponse>> completed;
+    std::unordered_map<std::string, CacheEntry> cache;
+    unsigned generation = 0;
+    unsigned inFlight = 0;
+
+    std::function<void()> notify;
+    HttpStandIn standIn;
+
+    void run();
+    void complete(Request request, HttpResponse response);
+};
+
+#endif /* HTTPCLIENT_H */
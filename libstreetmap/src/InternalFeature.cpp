@@ -1,11 +1,21 @@
 #include "InternalFeature.h"
 
+#include <algorithm>
+
 InternalFeature::InternalFeature(int id, ezgl::color colour, int level) {
     featureID = id;
     featureColour = colour;
     zoomLevel = level;
 }
 
+// Setters
+void InternalFeature::setGeometry(unsigned offset, unsigned count, bool isClosed, ezgl::rectangle bbox) {
+    pointOffset = offset;
+    pointCount = count;
+    closed = isClosed;
+    bounds = bbox;
+}
+
 // Getters
 int InternalFeature::getID() {
     return featureID;
@@ -19,4 +29,24 @@ int InternalFeature::getZoomLevel() {
     return zoomLevel;
 }
 
+unsigned InternalFeature::getPointOffset() {
+    return pointOffset;
+}
+
+unsigned InternalFeature::getPointCount() {
+    return pointCount;
+}
+
+bool InternalFeature::isClosed() {
+    return closed;
+}
+
+const ezgl::rectangle& InternalFeature::getBounds() {
+    return bounds;
+}
+
+// Largest side of the bounding box
+double InternalFeature::getExtent() {
+    return std::max(bounds.width(), bounds.height());
+}
 
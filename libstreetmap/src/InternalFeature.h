@@ -2,19 +2,34 @@
 #define INTERNALFEATURE_H
 
 #include <ezgl/color.hpp>
+#include <ezgl/rectangle.hpp>
 
 class InternalFeature {
 public:
     InternalFeature(int id, ezgl::color colour, int level);
     
+    // Setters
+    // Projected points are stored in store.FEATURE_POINTS, starting at offset
+    void setGeometry(unsigned offset, unsigned count, bool isClosed, ezgl::rectangle bbox);
+    
     // Getters
     int getID();
     ezgl::color getColour();
     int getZoomLevel();
+    unsigned getPointOffset();
+    unsigned getPointCount();
+    bool isClosed();
+    const ezgl::rectangle& getBounds();
+    double getExtent();
     
 private:
     int featureID, zoomLevel = 1;
     ezgl::color featureColour = ezgl::BLACK;
+    
+    // Geometry, built once in buildFeatureMap
+    unsigned pointOffset = 0, pointCount = 0;
+    bool closed = false;
+    ezgl::rectangle bounds = {{0, 0}, {0, 0}};
 
 };
 
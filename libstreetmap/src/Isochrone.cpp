@@ -0,0 +1,76 @@
+#include "Isochrone.h"
+#include "StreetsDatabaseAPI.h"
+#include "Store.h"
+
+// Search state of the calling thread, shared by both entry points
+static thread_local TurnSearchWorkspace workspace;
+
+/* Runs the bounded search and collects the time to every intersection
+ * An intersection is reached by the cheapest directed segment ending at it, found in one pass over the edge arrays
+ * @params source, rightTurnPenalty, leftTurnPenalty, timeLimit
+ * @returns generation of the search, whose visited directed segments hold their times in workspace.bestTimes
+ */
+static unsigned sweepFrom(unsigned source, double rightTurnPenalty, double leftTurnPenalty, double timeLimit, std::vector<double>& times) {
+    const TurnGraph& graph = store.turnGraph;
+    std::shared_ptr<const TurnMetric> metric = store.turnGraph.getMetric(rightTurnPenalty, leftTurnPenalty);
+    unsigned generation = graph.searchAll(source, *metric, workspace, timeLimit);
+
+    times.assign(getNumIntersections(), DBL_MAX);
+    times[source] = 0;
+    for (unsigned edge = 0; edge < graph.getEdgeCount(); edge++) {
+        if (workspace.visited[edge] != generation) continue;
+
+        unsigned head = graph.getEdgeHead(edge);
+        if (workspace.bestTimes[edge] < times[head]) times[head] = workspace.bestTimes[edge];
+    }
+
+    return generation;
+}
+
+std::vector<double> findTravelTimesFrom(const unsigned source, const double right_turn_penalty, const double left_turn_penalty,
+        const double timeLimit) {
+    std::vector<double> times;
+    if (source >= (unsigned)getNumIntersections()) {
+        times.assign(getNumIntersections(), DBL_MAX);
+        return times;
+    }
+
+    sweepFrom(source, right_turn_penalty, left_turn_penalty, timeLimit, times);
+    return times;
+}
+
+Isochrone findIsochrone(const unsigned source, const double timeLimit, const double right_turn_penalty, const double left_turn_penalty) {
+    Isochrone isochrone;
+    isochrone.source = source;
+    isochrone.timeLimit = timeLimit;
+    isochrone.rightTurnPenalty = right_turn_penalty;
+    isochrone.leftTurnPenalty = left_turn_penalty;
+    if (source >= (unsigned)getNumIntersections() || timeLimit < 0) return isochrone;
+
+    std::vector<double> times;
+    unsigned generation = sweepFrom(source, right_turn_penalty, left_turn_penalty, timeLimit, times);
+
+    isochrone.intersections.push_back(source);
+    isochrone.intersectionTimes.push_back(0);
+    for (unsigned intersection = 0; intersection < times.size(); intersection++) {
+        if (intersection == source || times[intersection] == DBL_MAX) continue;
+
+        isochrone.intersections.push_back(intersection);
+        isochrone.intersectionTimes.push_back(times[intersection]);
+    }
+
+    // The directed segments of a segment are adjacent, so this pass is in segment order
+    const TurnGraph& graph = store.turnGraph;
+    for (unsigned segment = 0; segment < graph.getEdgeCount() / 2; segment++) {
+        double time = DBL_MAX;
+        for (unsigned edge : {getForwardEdge(segment), getBackwardEdge(segment)}) {
+            if (workspace.visited[edge] == generation && workspace.bestTimes[edge] < time) time = workspace.bestTimes[edge];
+        }
+        if (time == DBL_MAX) continue;
+
+        isochrone.segments.push_back(segment);
+        isochrone.segmentTimes.push_back(time);
+    }
+
+    return isochrone;
+}
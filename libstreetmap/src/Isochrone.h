@@ -0,0 +1,45 @@
+/* One to all travel times and isochrones, what can be reached from an intersection within a time budget
+ * Both run a single Dijkstra over store.turnGraph from the source, so times are exact with turn penalties and match
+ * compute_path_travel_time of the path findTurnExactPath returns. The search stops at the time limit, a small
+ * isochrone only touches the directed segments in reach, then one linear pass over the flat arrays collects them
+ * Safe to call from several threads at once, each thread keeps its own workspace
+ */
+
+#ifndef ISOCHRONE_H
+#define ISOCHRONE_H
+
+#include <cfloat>
+#include <vector>
+
+#include "TurnGraph.h"
+
+// Everything reachable from a source within a time limit
+struct Isochrone {
+    unsigned source = 0;
+    double timeLimit = 0;
+    double rightTurnPenalty = 0;
+    double leftTurnPenalty = 0;
+
+    // Intersections in reach and the travel time to each, the source first at time 0
+    std::vector<unsigned> intersections;
+    std::vector<double> intersectionTimes;
+
+    // Segments that can be travelled end to end in either direction and the earliest time one is, ascending ids
+    std::vector<unsigned> segments;
+    std::vector<double> segmentTimes;
+};
+
+/* Travel time from a source to every intersection
+ * @params source intersection, right_turn_penalty, left_turn_penalty, timeLimit past which the search stops
+ * @returns time to each intersection by id, 0 for the source and DBL_MAX if it is not reached within timeLimit
+ */
+std::vector<double> findTravelTimesFrom(const unsigned source, const double right_turn_penalty, const double left_turn_penalty,
+        const double timeLimit = DBL_MAX);
+
+/* Intersections and segments reachable from a source within a time limit
+ * @params source intersection, timeLimit in seconds, right_turn_penalty, left_turn_penalty
+ * @returns the isochrone, with only the source if it has no way out
+ */
+Isochrone findIsochrone(const unsigned source, const double timeLimit, const double right_turn_penalty, const double left_turn_penalty);
+
+#endif /* ISOCHRONE_H */
@@ -0,0 +1,152 @@
+#include "LoadReport.h"
+#include "ReportUtil.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/resource.h>
+
+long getPeakRSS() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+    // ru_maxrss is in kB on Linux
+    return usage.ru_maxrss;
+}
+
+void LoadReport::start(std::string name) {
+    mapName = name;
+    phases.clear();
+    containers.clear();
+    totalTime = 0;
+    startPeakRSS = getPeakRSS();
+    reportStart = Clock::now();
+}
+
+void LoadReport::finish() {
+    totalTime = elapsedMilliseconds(reportStart);
+}
+
+void LoadReport::startPhase(std::string name) {
+    current = LoadPhase();
+    current.name = name;
+    current.startTime = elapsedMilliseconds(reportStart);
+    phasePeakRSS = getPeakRSS();
+    phaseStart = Clock::now();
+}
+
+void LoadReport::endPhase() {
+    current.wallTime = elapsedMilliseconds(phaseStart);
+    current.rssDelta = getPeakRSS() - phasePeakRSS;
+    phases.push_back(current);
+}
+
+void LoadReport::addPhase(std::string name, double startTime, double wallTime, long rssDelta) {
+    LoadPhase phase;
+    phase.name = name;
+    phase.startTime = startTime;
+    phase.wallTime = wallTime;
+    phase.rssDelta = rssDelta;
+    phases.push_back(phase);
+}
+
+void LoadReport::addContainer(std::string name, std::size_t size, std::size_t bytes) {
+    ContainerStat container;
+    container.name = name;
+    container.size = size;
+    container.bytes = bytes;
+    containers.push_back(container);
+}
+
+void LoadReport::setBudget(std::string phase, double budget) {
+    budgets[phase] = budget;
+}
+
+void LoadReport::setDefaultBudget(double budget) {
+    defaultBudget = budget;
+}
+
+double LoadReport::getBudget(const std::string& phase) {
+    auto budget = budgets.find(phase);
+    return budget == budgets.end() ? defaultBudget : budget->second;
+}
+
+double LoadReport::getTotalTime() {
+    return totalTime;
+}
+
+std::vector<LoadPhase> LoadReport::getPhases() {
+    return phases;
+}
+
+std::vector<ContainerStat> LoadReport::getContainers() {
+    return containers;
+}
+
+// Names of the phases that took longer than their budget, in load order
+std::vector<std::string> LoadReport::getOverBudget() {
+    std::vector<std::string> over;
+    for (auto phase = phases.begin(); phase != phases.end(); phase++) {
+        double budget = getBudget(phase->name);
+        if (budget > 0 && phase->wallTime > budget) over.push_back(phase->name);
+    }
+    return over;
+}
+
+// Builds a table of the phases then the containers, phases over budget are marked
+std::string LoadReport::getSummary() {
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(1);
+    summary << "Load report for " << mapName << ": " << totalTime << "ms, peak RSS +" << (getPeakRSS() - startPeakRSS) << "kB\n";
+
+    for (auto phase = phases.begin(); phase != phases.end(); phase++) {
+        summary << "  " << std::left << std::setw(32) << phase->name << std::right
+                << std::setw(10) << phase->wallTime << "ms  at " << std::setw(8) << phase->startTime << "ms";
+        if (phase->rssDelta != UNKNOWN_RSS_DELTA) summary << "  RSS +" << phase->rssDelta << "kB";
+
+        double budget = getBudget(phase->name);
+        if (budget > 0 && phase->wallTime > budget) summary << "  OVER BUDGET (" << budget << "ms)";
+        summary << "\n";
+    }
+
+    for (auto container = containers.begin(); container != containers.end(); container++) {
+        summary << "  " << std::left << std::setw(32) << container->name << std::right
+                << std::setw(10) << container->size << " items " << std::setw(12) << container->bytes << " bytes\n";
+    }
+
+    return summary.str();
+}
+
+bool LoadReport::writeJSON(std::string path) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file << "{\n  \"map\": " << quoteJSON(mapName) << ",\n";
+    file << "  \"total_ms\": " << totalTime << ",\n";
+    file << "  \"peak_rss_kb\": " << getPeakRSS() << ",\n";
+    file << "  \"peak_rss_delta_kb\": " << (getPeakRSS() - startPeakRSS) << ",\n";
+
+    file << "  \"phases\": [";
+    for (auto phase = phases.begin(); phase != phases.end(); phase++) {
+        double budget = getBudget(phase->name);
+
+        file << (phase == phases.begin() ? "\n" : ",\n");
+        file << "    {\"name\": " << quoteJSON(phase->name) << ", \"start_ms\": " << phase->startTime
+             << ", \"wall_ms\": " << phase->wallTime << ", \"peak_rss_delta_kb\": ";
+        if (phase->rssDelta == UNKNOWN_RSS_DELTA) file << "null"; else file << phase->rssDelta;
+        file << ", \"budget_ms\": ";
+        if (budget > 0) file << budget; else file << "null";
+        file << ", \"over_budget\": " << (budget > 0 && phase->wallTime > budget ? "true" : "false") << "}";
+    }
+    file << "\n  ],\n";
+
+    file << "  \"containers\": [";
+    for (auto container = containers.begin(); container != containers.end(); container++) {
+        file << (container == containers.begin() ? "\n" : ",\n");
+        file << "    {\"name\": " << quoteJSON(container->name) << ", \"size\": " << container->size
+             << ", \"bytes\": " << container->bytes << "}";
+    }
+    file << "\n  ]\n}\n";
+
+    return true;
+}
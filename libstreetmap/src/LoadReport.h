@@ -0,0 +1,85 @@
+/* LoadReport records how long each phase of load_map took, how much the peak RSS grew
+ * during it, and the size of every Store container once the map is loaded
+ * Phases can be given a time budget, so a load that regressed past it can be failed
+ * The report is printed as a table or written as JSON to be compared across releases
+ */
+
+#ifndef LOADREPORT_H
+#define LOADREPORT_H
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+// Peak RSS growth is unknown for phases that ran concurrently with other phases
+#define UNKNOWN_RSS_DELTA -1
+
+struct LoadPhase {
+    std::string name;
+    double startTime = 0;
+    double wallTime = 0;
+    long rssDelta = UNKNOWN_RSS_DELTA;
+};
+
+struct ContainerStat {
+    std::string name;
+    std::size_t size = 0;
+    std::size_t bytes = 0;
+};
+
+class LoadReport {
+public:
+    // Starts a new report, budgets are kept
+    void start(std::string mapName);
+    void finish();
+
+    // Times a phase that runs alone, so its peak RSS growth is measured as well
+    void startPhase(std::string name);
+    void endPhase();
+
+    // Adds a phase timed elsewhere, start is in ms since the report started
+    void addPhase(std::string name, double startTime, double wallTime, long rssDelta = UNKNOWN_RSS_DELTA);
+
+    // Bytes are an estimate of the memory owned by the container
+    void addContainer(std::string name, std::size_t size, std::size_t bytes);
+
+    // Budgets in ms, a phase without its own budget uses the default budget, 0 is no budget
+    void setBudget(std::string phase, double budget);
+    void setDefaultBudget(double budget);
+
+    // Getters
+    double getTotalTime();
+    std::vector<LoadPhase> getPhases();
+    std::vector<ContainerStat> getContainers();
+    std::vector<std::string> getOverBudget();
+    std::string getSummary();
+
+    // Writes the report as a JSON object, returns false if the file could not be opened
+    bool writeJSON(std::string path);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::string mapName;
+    Clock::time_point reportStart;
+    double totalTime = 0;
+    long startPeakRSS = 0;
+
+    LoadPhase current;
+    Clock::time_point phaseStart;
+    long phasePeakRSS = 0;
+
+    std::vector<LoadPhase> phases;
+    std::vector<ContainerStat> containers;
+
+    std::map<std::string, double> budgets;
+    double defaultBudget = 0;
+
+    double getBudget(const std::string& phase);
+};
+
+// Peak resident set size of the process so far in kB
+long getPeakRSS();
+
+#endif /* LOADREPORT_H */
@@ -0,0 +1,107 @@
+#include "LocationService.h"
+#include "util.h"
+
+#include <cstdlib>
+#include <sstream>
+
+LocationService::~LocationService() {
+    stop();
+}
+
+void LocationService::start(LocationProvider provider) {
+    stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (known) {
+        state = LOCATION_READY;
+        return;
+    }
+
+    state = LOCATION_PENDING;
+    cancelled = false;
+
+    worker = std::thread([this, provider]() {
+        LatLon position;
+        bool found = false;
+        try {
+            found = provider(position, cancelled);
+        } catch (...) {
+            found = false;
+        }
+
+        std::lock_guard<std::mutex> resultLock(mutex);
+        if (found) {
+            location = position;
+            known = true;
+        }
+        
+        // A cancelled lookup did not fail, it is retried by the next start
+        if (found) state = LOCATION_READY;
+        else state = cancelled ? LOCATION_UNKNOWN : LOCATION_FAILED;
+    });
+}
+
+void LocationService::stop() {
+    cancelled = true;
+    if (worker.joinable()) worker.join();
+}
+
+void LocationService::setLocation(LatLon position) {
+    stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    location = position;
+    known = true;
+    state = LOCATION_READY;
+}
+
+LocationState LocationService::getState() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return state;
+}
+
+bool LocationService::getLocation(LatLon& position) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (known) position = location;
+    return known;
+}
+
+/* Looks up the location of the user's IP address, gives up after LOCATION_TIMEOUT
+ * @params position to set, cancelled flag checked while the request is in flight
+ * @returns whether a location was found
+ */
+bool fetchIPLocation(LatLon& position, const std::atomic<bool>& cancelled) {
+    using namespace boost::property_tree;
+
+    std::string url = "https://api.ipdata.co/?api-key=570c726f0272bf61a8acce72ff76e37eb4e871045bdfa305c1bed191";
+    std::string response;
+    if (!fetchURL(url, LOCATION_TIMEOUT, response, &cancelled)) return false;
+
+    // Parse into property trees
+    ptree propertyTree;
+    std::istringstream inputStream(response);
+    read_json(inputStream, propertyTree);
+
+    boost::optional<float> lat = propertyTree.get_optional<float>("latitude");
+    boost::optional<float> lon = propertyTree.get_optional<float>("longitude");
+    if (!lat || !lon) return false;
+
+    position = LatLon(*lat, *lon);
+    return true;
+}
+
+LatLon getStandInLatLon(LatLon fallback) {
+    const char* configured = std::getenv("MAPPER_USER_LOCATION");
+    if (configured == nullptr) return fallback;
+
+    float lat, lon;
+    char comma;
+    std::istringstream input(configured);
+    if (!(input >> lat >> comma >> lon) || comma != ',') return fallback;
+
+    return LatLon(lat, lon);
+}
+
+bool useStandInLocation() {
+    return std::getenv("MAPPER_OFFLINE") != nullptr || std::getenv("MAPPER_USER_LOCATION") != nullptr;
+}
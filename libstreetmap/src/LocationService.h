@@ -0,0 +1,69 @@
+/* LocationService looks up the user's location on a background thread, so load_map never waits on the network
+ * The lookup has a timeout and can be cancelled, and the last location found is kept for the next map load
+ * Without a network, a stand-in location can be set directly instead
+ */
+
+#ifndef LOCATIONSERVICE_H
+#define LOCATIONSERVICE_H
+
+#include "LatLon.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Lookup limits in ms
+#define LOCATION_TIMEOUT 5000
+#define LOCATION_POLL_INTERVAL 250
+
+enum LocationState {
+    LOCATION_UNKNOWN = 0,
+    LOCATION_PENDING,
+    LOCATION_READY,
+    LOCATION_FAILED
+};
+
+// Finds a location, should return early with false once cancelled is set
+typedef std::function<bool(LatLon& position, const std::atomic<bool>& cancelled)> LocationProvider;
+
+class LocationService {
+public:
+    ~LocationService();
+
+    // Starts a lookup on a background thread, unless a location is already known
+    void start(LocationProvider provider);
+
+    // Cancels a running lookup and waits for its thread
+    void stop();
+
+    // Setters
+    void setLocation(LatLon position);
+
+    // Getters
+    LocationState getState();
+
+    // Last location found, false if none is known yet
+    bool getLocation(LatLon& position);
+
+private:
+    std::thread worker;
+    std::atomic<bool> cancelled{false};
+
+    std::mutex mutex;
+    LocationState state = LOCATION_UNKNOWN;
+    bool known = false;
+    LatLon location;
+};
+
+// Location of the user's IP address from a geolocation API
+bool fetchIPLocation(LatLon& position, const std::atomic<bool>& cancelled);
+
+// Stand-in location for offline use, from MAPPER_USER_LOCATION="lat,lon" if set, otherwise fallback
+LatLon getStandInLatLon(LatLon fallback);
+
+// Whether the stand-in location should be used instead of a lookup, set by MAPPER_OFFLINE or MAPPER_USER_LOCATION
+bool useStandInLocation();
+
+#endif /* LOCATIONSERVICE_H */
@@ -0,0 +1,367 @@
+#include "NameIndex.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+#include <set>
+
+// Lowercase key prefixed with the entity type
+static std::string makeKey(std::string name, NameEntityType type) {
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    return std::string(1, static_cast<char>(type)) + name;
+}
+
+void NameIndex::insert(std::string name, unsigned id, NameEntityType type) {
+    std::string key = makeKey(name, type);
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.push_back(std::make_pair(key, NameEntry{id, type}));
+}
+
+void NameIndex::insert(const std::vector<std::pair<std::string, NameEntry>>& names) {
+    std::vector<std::pair<std::string, NameEntry>> keys;
+    keys.reserve(names.size());
+    for (auto name = names.begin(); name != names.end(); name++) {
+        keys.push_back(std::make_pair(makeKey(name->first, name->second.type), name->second));
+    }
+
+    // One lock per batch
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.insert(pending.end(), keys.begin(), keys.end());
+}
+
+void NameIndex::build() {
+    std::sort(pending.begin(), pending.end(), [](const std::pair<std::string, NameEntry>& lhs, const std::pair<std::string, NameEntry>& rhs) {
+        if (lhs.first != rhs.first) return lhs.first < rhs.first;
+        return lhs.second.id < rhs.second.id;
+    });
+
+    nodes.clear();
+    labels.clear();
+    entries.clear();
+
+    nodes.push_back(Node());
+    buildNode(0, 0, pending.size(), 0);
+
+    entries.reserve(pending.size());
+    for (auto it = pending.begin(); it != pending.end(); it++) {
+        entries.push_back(it->second);
+    }
+
+    // Release the staging strings
+    std::vector<std::pair<std::string, NameEntry>>().swap(pending);
+    nodes.shrink_to_fit();
+    labels.shrink_to_fit();
+}
+
+/* Builds the subtree of node from the sorted pending keys [lo, hi), which share their first depth characters
+ * Children are allocated contiguously before recursing, ordered by their first label character
+ * @params node index, pending range, depth of the node in characters
+ * @returns void
+ */
+void NameIndex::buildNode(unsigned node, unsigned lo, unsigned hi, unsigned depth) {
+    nodes[node].entryBegin = lo;
+    nodes[node].entryEnd = hi;
+
+    // Keys ending here sort first
+    unsigned i = lo;
+    while (i < hi && pending[i].first.size() == depth) i++;
+    nodes[node].terminalEnd = i;
+
+    // Group the rest by their next character, each group becomes a child labelled with the group's common prefix
+    std::vector<std::pair<std::pair<unsigned, unsigned>, unsigned>> groups;
+    while (i < hi) {
+        char next = pending[i].first[depth];
+        unsigned j = i;
+        while (j < hi && pending[j].first[depth] == next) j++;
+
+        // Common prefix of a sorted range is the common prefix of its first and last keys
+        const std::string& first = pending[i].first;
+        const std::string& last = pending[j - 1].first;
+        unsigned common = depth;
+        while (common < first.size() && common < last.size() && first[common] == last[common]) common++;
+
+        groups.push_back(std::make_pair(std::make_pair(i, j), common));
+        i = j;
+    }
+
+    unsigned childBegin = nodes.size();
+    for (auto group = groups.begin(); group != groups.end(); group++) {
+        Node child;
+        child.labelOffset = labels.size();
+        child.labelLength = group->second - depth;
+
+        const std::string& key = pending[group->first.first].first;
+        labels.insert(labels.end(), key.begin() + depth, key.begin() + group->second);
+        nodes.push_back(child);
+    }
+    nodes[node].childBegin = childBegin;
+    nodes[node].childEnd = nodes.size();
+
+    for (unsigned child = 0; child < groups.size(); child++) {
+        buildNode(childBegin + child, groups[child].first.first, groups[child].first.second, groups[child].second);
+    }
+}
+
+/* Walks the trie along key
+ * @params key, onBoundary is set when the key ends exactly at the returned node, path (optional) receives the node's full path
+ * @returns the deepest node whose path starts with key, -1 if no key starts with it
+ */
+int NameIndex::findNode(const std::string& key, bool& onBoundary, std::string* path) {
+    onBoundary = true;
+    if (nodes.empty()) return -1;
+
+    unsigned node = 0;
+    unsigned position = 0;
+
+    while (position < key.size()) {
+        int next = -1;
+        for (unsigned child = nodes[node].childBegin; child < nodes[node].childEnd; child++) {
+            if (labels[nodes[child].labelOffset] == key[position]) {
+                next = child;
+                break;
+            }
+        }
+        if (next == -1) return -1;
+
+        const Node& child = nodes[next];
+        unsigned length = std::min<unsigned>(child.labelLength, key.size() - position);
+        if (!std::equal(key.begin() + position, key.begin() + position + length, labels.begin() + child.labelOffset)) return -1;
+
+        onBoundary = length == child.labelLength;
+        position += length;
+        node = next;
+        
+        if (path) path->append(labels.begin() + child.labelOffset, labels.begin() + child.labelOffset + child.labelLength);
+    }
+
+    return node;
+}
+
+std::vector<unsigned> NameIndex::findPrefix(std::string prefix, NameEntityType type) {
+    std::vector<unsigned> ids;
+
+    bool onBoundary;
+    int node = findNode(makeKey(prefix, type), onBoundary);
+    if (node == -1) return ids;
+
+    for (unsigned entry = nodes[node].entryBegin; entry < nodes[node].entryEnd; entry++) {
+        ids.push_back(entries[entry].id);
+    }
+
+    return ids;
+}
+
+std::vector<unsigned> NameIndex::findExact(std::string name, NameEntityType type) {
+    std::vector<unsigned> ids;
+
+    bool onBoundary;
+    int node = findNode(makeKey(name, type), onBoundary);
+    if (node == -1 || !onBoundary) return ids;
+
+    for (unsigned entry = nodes[node].entryBegin; entry < nodes[node].terminalEnd; entry++) {
+        ids.push_back(entries[entry].id);
+    }
+
+    return ids;
+}
+
+std::vector<NameEntry> NameIndex::findPrefix(std::string prefix) {
+    std::vector<NameEntry> found;
+
+    for (int type = 0; type < NAME_ENTITY_COUNT; type++) {
+        bool onBoundary;
+        int node = findNode(makeKey(prefix, (NameEntityType)type), onBoundary);
+        if (node == -1) continue;
+
+        found.insert(found.end(), entries.begin() + nodes[node].entryBegin, entries.begin() + nodes[node].entryEnd);
+    }
+
+    return found;
+}
+
+std::vector<NameEntry> NameIndex::complete(std::string prefix, unsigned maxResults) {
+    std::vector<NameEntry> completions;
+    if (nodes.empty()) return completions;
+
+    // Nodes to expand with their path (without type tag), shortest path first, then alphabetical
+    typedef std::pair<std::string, unsigned> PathNode;
+    auto longer = [](const PathNode& lhs, const PathNode& rhs) {
+        if (lhs.first.size() != rhs.first.size()) return lhs.first.size() > rhs.first.size();
+        return lhs.first > rhs.first;
+    };
+    std::priority_queue<PathNode, std::vector<PathNode>, decltype(longer)> queue(longer);
+
+    for (int type = 0; type < NAME_ENTITY_COUNT; type++) {
+        bool onBoundary;
+        std::string path;
+        int node = findNode(makeKey(prefix, (NameEntityType)type), onBoundary, &path);
+        if (node != -1) queue.push(std::make_pair(path.substr(1), (unsigned)node));
+    }
+
+    // Children are always longer than their parent, so names come out in rank order
+    std::set<std::string> seen;
+    while (!queue.empty() && completions.size() < maxResults) {
+        PathNode current = queue.top();
+        queue.pop();
+
+        const Node& node = nodes[current.second];
+        if (node.entryBegin < node.terminalEnd && seen.insert(current.first).second) {
+            completions.push_back(entries[node.entryBegin]);
+        }
+
+        for (unsigned child = node.childBegin; child < node.childEnd; child++) {
+            auto label = labels.begin() + nodes[child].labelOffset;
+            queue.push(std::make_pair(current.first + std::string(label, label + nodes[child].labelLength), child));
+        }
+    }
+
+    return completions;
+}
+
+std::vector<FuzzyMatch> NameIndex::findFuzzy(std::string query, NameEntityType type, unsigned maxDistance, unsigned maxResults) {
+    std::vector<FuzzyMatch> matches;
+    if (nodes.empty()) return matches;
+
+    std::transform(query.begin(), query.end(), query.begin(), ::tolower);
+
+    // rows[d] is the edit distance row of the first d name characters against every query prefix
+    std::vector<std::vector<unsigned>> rows(1, std::vector<unsigned>(query.size() + 1));
+    for (unsigned j = 0; j <= query.size(); j++) rows[0][j] = j;
+
+    // name holds the type tag, followed by the name characters
+    for (unsigned child = nodes[0].childBegin; child < nodes[0].childEnd; child++) {
+        if (labels[nodes[child].labelOffset] != static_cast<char>(type)) continue;
+
+        std::string name;
+        fuzzyNode(child, query, maxDistance, name, rows, matches);
+    }
+
+    std::sort(matches.begin(), matches.end(), [&query](const FuzzyMatch& lhs, const FuzzyMatch& rhs) {
+        if (lhs.distance != rhs.distance) return lhs.distance < rhs.distance;
+
+        long lhsLength = std::labs((long)lhs.name.size() - (long)query.size());
+        long rhsLength = std::labs((long)rhs.name.size() - (long)query.size());
+        if (lhsLength != rhsLength) return lhsLength < rhsLength;
+
+        return lhs.name < rhs.name;
+    });
+    if (matches.size() > maxResults) matches.resize(maxResults);
+
+    return matches;
+}
+
+/* Walks the trie below node, extending the edit distance rows one character at a time
+ * Subtrees are pruned once every entry of the current row exceeds maxDistance
+ * @params node, query, maxDistance, name of the path so far (with type tag), rows for the path so far, matches to append to
+ * @returns void
+ */
+void NameIndex::fuzzyNode(unsigned node, const std::string& query, unsigned maxDistance, std::string& name,
+        std::vector<std::vector<unsigned>>& rows, std::vector<FuzzyMatch>& matches) {
+    unsigned length = name.size();
+    unsigned labelBegin = nodes[node].labelOffset;
+    unsigned labelEnd = labelBegin + nodes[node].labelLength;
+
+    // The type tag is not part of the name
+    if (length == 0) {
+        name.push_back(labels[labelBegin]);
+        labelBegin++;
+    }
+
+    for (unsigned label = labelBegin; label < labelEnd; label++) {
+        char c = labels[label];
+        name.push_back(c);
+
+        // Depth of the new row, in name characters
+        unsigned d = name.size() - 1;
+        if (rows.size() <= d) rows.resize(d + 1, std::vector<unsigned>(query.size() + 1));
+
+        const std::vector<unsigned>& previous = rows[d - 1];
+        std::vector<unsigned>& row = rows[d];
+        row[0] = d;
+        unsigned rowMin = row[0];
+
+        for (unsigned j = 1; j <= query.size(); j++) {
+            row[j] = std::min(std::min(previous[j] + 1, row[j - 1] + 1), previous[j - 1] + (query[j - 1] != c));
+
+            // Adjacent transposition
+            if (d > 1 && j > 1 && query[j - 1] == name[d - 1] && query[j - 2] == c) {
+                row[j] = std::min(row[j], rows[d - 2][j - 2] + 1);
+            }
+            rowMin = std::min(rowMin, row[j]);
+        }
+
+        if (rowMin > maxDistance) {
+            name.resize(length);
+            return;
+        }
+    }
+
+    unsigned distance = rows[name.size() - 1][query.size()];
+    if (distance <= maxDistance && nodes[node].entryBegin < nodes[node].terminalEnd) {
+        FuzzyMatch match;
+        match.name = name.substr(1);
+        match.distance = distance;
+        for (unsigned entry = nodes[node].entryBegin; entry < nodes[node].terminalEnd; entry++) {
+            match.ids.push_back(entries[entry].id);
+        }
+        matches.push_back(match);
+    }
+
+    for (unsigned child = nodes[node].childBegin; child < nodes[node].childEnd; child++) {
+        fuzzyNode(child, query, maxDistance, name, rows, matches);
+    }
+
+    name.resize(length);
+}
+
+void NameIndex::forEachName(NameEntityType type, std::function<void(const std::string&, const std::vector<unsigned>&)> visit) {
+    if (nodes.empty()) return;
+
+    // The first label character of the root's children is the type tag
+    for (unsigned child = nodes[0].childBegin; child < nodes[0].childEnd; child++) {
+        if (labels[nodes[child].labelOffset] != static_cast<char>(type)) continue;
+
+        std::string name;
+        visitNode(child, name, visit);
+    }
+}
+
+// Depth first, in sorted order, name holds the path including the type tag
+void NameIndex::visitNode(unsigned node, std::string& name, std::function<void(const std::string&, const std::vector<unsigned>&)>& visit) {
+    unsigned length = name.size();
+
+    auto label = labels.begin() + nodes[node].labelOffset;
+    name.append(label, label + nodes[node].labelLength);
+
+    if (nodes[node].entryBegin < nodes[node].terminalEnd) {
+        std::vector<unsigned> ids;
+        for (unsigned entry = nodes[node].entryBegin; entry < nodes[node].terminalEnd; entry++) {
+            ids.push_back(entries[entry].id);
+        }
+        visit(name.substr(1), ids);
+    }
+
+    for (unsigned child = nodes[node].childBegin; child < nodes[node].childEnd; child++) {
+        visitNode(child, name, visit);
+    }
+
+    name.resize(length);
+}
+
+std::size_t NameIndex::getMemoryUsage() {
+    return nodes.capacity() * sizeof(Node) + labels.capacity() + entries.capacity() * sizeof(NameEntry);
+}
+
+unsigned NameIndex::size() {
+    return entries.size() + pending.size();
+}
+
+void NameIndex::clear() {
+    nodes.clear();
+    labels.clear();
+    entries.clear();
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.clear();
+}
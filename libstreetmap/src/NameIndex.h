@@ -0,0 +1,92 @@
+/* NameIndex is a compressed (radix) trie over the lowercase names of streets, POIs and intersections
+ * Names are inserted while the map loads, then build() packs them into flat arrays:
+ * nodes in one vector, edge labels in one char buffer, and entries sorted by name, so the entries
+ * below any node are contiguous and a prefix query costs the prefix length plus the number of results
+ * Each key is tagged with its entity type, so queries for one type never visit the other types
+ */
+
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum NameEntityType {
+    STREET_ENTITY = 0,
+    POI_ENTITY,
+    INTERSECTION_ENTITY,
+    NAME_ENTITY_COUNT
+};
+
+struct NameEntry {
+    unsigned id;
+    NameEntityType type;
+};
+
+// Name within the edit distance of a fuzzy query, with the ids sharing that name
+struct FuzzyMatch {
+    std::string name;
+    unsigned distance;
+    std::vector<unsigned> ids;
+};
+
+class NameIndex {
+public:
+    // Thread safe, only valid before build
+    void insert(std::string name, unsigned id, NameEntityType type);
+    void insert(const std::vector<std::pair<std::string, NameEntry>>& names);
+
+    // Packs the inserted names into the trie, to be called once all names are inserted
+    void build();
+
+    // Queries are case insensitive, ids are ordered by name then id
+    std::vector<unsigned> findPrefix(std::string prefix, NameEntityType type);
+    std::vector<unsigned> findExact(std::string name, NameEntityType type);
+
+    // Prefix query over every entity type
+    std::vector<NameEntry> findPrefix(std::string prefix);
+
+    // One entry per distinct name starting with prefix, over every entity type
+    // Shortest names first, then alphabetical, at most maxResults, cost grows with maxResults rather than the matches
+    std::vector<NameEntry> complete(std::string prefix, unsigned maxResults);
+
+    // Names within maxDistance edits (insert, delete, substitute, swap adjacent) of query
+    // Ranked by distance, then closest length, then name, at most maxResults
+    std::vector<FuzzyMatch> findFuzzy(std::string query, NameEntityType type, unsigned maxDistance, unsigned maxResults);
+
+    // Visits every distinct name of a type in sorted order, with the ids sharing that name
+    void forEachName(NameEntityType type, std::function<void(const std::string&, const std::vector<unsigned>&)> visit);
+
+    unsigned size();
+    void clear();
+
+    // Bytes held by the packed trie
+    std::size_t getMemoryUsage();
+
+private:
+    // Entries of the subtree are [entryBegin, entryEnd), names ending at this node are [entryBegin, terminalEnd)
+    struct Node {
+        unsigned labelOffset = 0, labelLength = 0;
+        unsigned childBegin = 0, childEnd = 0;
+        unsigned entryBegin = 0, terminalEnd = 0, entryEnd = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<char> labels;
+    std::vector<NameEntry> entries;
+
+    // Tagged names waiting for build
+    std::vector<std::pair<std::string, NameEntry>> pending;
+    std::mutex pendingMutex;
+
+    void buildNode(unsigned node, unsigned lo, unsigned hi, unsigned depth);
+    int findNode(const std::string& key, bool& onBoundary, std::string* path = nullptr);
+    void visitNode(unsigned node, std::string& name, std::function<void(const std::string&, const std::vector<unsigned>&)>& visit);
+    void fuzzyNode(unsigned node, const std::string& query, unsigned maxDistance, std::string& name,
+            std::vector<std::vector<unsigned>>& rows, std::vector<FuzzyMatch>& matches);
+};
+
+#endif /* NAMEINDEX_H */
@@ -2,6 +2,7 @@
 
 void drawStreets(ezgl::renderer &g) {
     bool shouldDraw;
+    unsigned drawn = 0, culled = 0;
     
     g.set_line_cap(ezgl::line_cap::round);
     for (auto segmentIndex = store.SEGMENTS.begin(); segmentIndex != store.SEGMENTS.end(); segmentIndex++) {
@@ -18,15 +19,21 @@ void drawStreets(ezgl::renderer &g) {
         
         //to determine which segments to draw, depending on the zoom level
         shouldDraw = segmentObject.getDrawLevel() <= store.zoomLevel;
+        if (!shouldDraw) {
+            culled++;
+            continue;
+        }
         
         //iterates through all the points of the segment
-        for (auto currentPoint = points.begin(); currentPoint != points.end() -1 && shouldDraw; currentPoint++) {
+        for (auto currentPoint = points.begin(); currentPoint != points.end() -1; currentPoint++) {
             const LatLon& nextPoint = *(currentPoint + 1);
             
             g.set_color(segmentObject.getSegmentColour());
             g.draw_line({lonToX(currentPoint->lon()), latToY(currentPoint->lat())}, {lonToX(nextPoint.lon()), latToY(nextPoint.lat())});
+            drawn++;
 
             if (name != "<unknown>" && store.zoomLevel >= 8) {
+                 drawn++;
                  g.set_color(38, 50, 56);
                  LatLon avg = averageLatLon(*currentPoint, nextPoint);
                  double x1 = lonToX(currentPoint->lon());
@@ -54,10 +61,13 @@ void drawStreets(ezgl::renderer &g) {
 
         }
     }
+    
+    store.renderProfiler.addCounts(STREETS_LAYER, drawn, culled);
 }
 
 void drawPath(ezgl::renderer &g){
     if(store.path.size() == 0) return;
+    unsigned drawn = 0;
     
     for(auto it = store.path.begin(); it != store.path.end(); it++){
         StreetSegment& segmentObject = *(store.SEGMENTS[*it]);
@@ -72,8 +82,10 @@ void drawPath(ezgl::renderer &g){
 
             g.set_color(ezgl::LIGHT_BLUE);
             g.draw_line({lonToX(currentPoint->lon()), latToY(currentPoint->lat())}, {lonToX(nextPoint.lon()), latToY(nextPoint.lat())});
+            drawn++;
 
             if (name != "<unknown>" && store.zoomLevel >= 8) {
+                 drawn++;
                  g.set_color(38, 50, 56);
                  LatLon avg = averageLatLon(*currentPoint, nextPoint);
                  double x1 = lonToX(currentPoint->lon());
@@ -102,61 +114,90 @@ void drawPath(ezgl::renderer &g){
         }
     }
     
+    store.renderProfiler.addCounts(PATH_LAYER, drawn, 0);
+}
+
+//draws the segments of store.isochrone, shaded from green near the source to red at the time limit
+void drawIsochrone(ezgl::renderer &g) {
+    const Isochrone& isochrone = store.isochrone;
+    if (isochrone.segments.empty()) return;
+    unsigned drawn = 0;
+
+    g.set_line_width(4);
+    g.set_line_cap(ezgl::line_cap::round);
+    for (unsigned index = 0; index < isochrone.segments.size(); index++) {
+        double fraction = isochrone.timeLimit > 0 ? isochrone.segmentTimes[index] / isochrone.timeLimit : 1;
+        g.set_color(255 * fraction, 255 * (1 - fraction), 0, 160);
+
+        const std::vector<LatLon>& points = store.SEGMENTS[isochrone.segments[index]]->getSegmentPoints();
+        for (auto currentPoint = points.begin(); currentPoint != points.end() - 1; currentPoint++) {
+            const LatLon& nextPoint = *(currentPoint + 1);
+            g.draw_line({lonToX(currentPoint->lon()), latToY(currentPoint->lat())}, {lonToX(nextPoint.lon()), latToY(nextPoint.lat())});
+            drawn++;
+        }
+    }
+
+    store.renderProfiler.addCounts(ISOCHRONE_LAYER, drawn, 0);
 }
 
 void drawFeatures(ezgl::renderer &g) {
-    const int featureTypeCount = 9;
-    
-    //different priorities for different types of maps
-    FeatureType defaultFeaturePriorityArray[featureTypeCount] = {Park, Lake, Island, Beach, River, Stream, Greenspace, Golfcourse, Building};
-    FeatureType islandFeaturePriorityArray[featureTypeCount] = {Lake, Island, Beach, River, Stream, Greenspace, Golfcourse, Park, Building};
-    
     g.set_line_width(1);
+    unsigned drawn = 0, culled = 0;
     
-    for (int featureType = 0; featureType < featureTypeCount; featureType++) {
-        
-        std::pair<std::multimap<FeatureType, InternalFeature*>::iterator, std::multimap<FeatureType, InternalFeature*>::iterator> bounds;
-        
-        // Select feature priority depending on map type
-        if (store.mapName == "saint-helena" || store.mapName == "new-york_usa") {
-           bounds = store.FEATURES_TYPE_MAP.equal_range(islandFeaturePriorityArray[featureType]);
-        } 
-        else {
-           bounds = store.FEATURES_TYPE_MAP.equal_range(defaultFeaturePriorityArray[featureType]);
-        }
+    // Size of a pixel in world coordinates, anything smaller is not drawn
+    ezgl::rectangle visibleWorld = g.get_visible_world();
+    ezgl::point2d pixel = g.get_world_scale_factor();
+    
+    // Buckets are already in paint order, see buildFeatureMap
+    for (auto bucket = store.FEATURE_BUCKETS.begin(); bucket != store.FEATURE_BUCKETS.end(); bucket++) {
+        if (bucket->empty()) continue;
         
-        g.set_color(bounds.first->second->getColour());
+        // Every feature of a type shares its colour
+        g.set_color(bucket->front().getColour());
         
-        for (auto featureIterator = bounds.first; featureIterator != bounds.second; featureIterator++) {
-            int i = featureIterator->second->getID();
-            int count = getFeaturePointCount(i);
+        for (auto feature = bucket->begin(); feature != bucket->end(); feature++) {
+            // Buckets are sorted by zoom level, the rest of the bucket is hidden at this zoom
+            if (store.zoomLevel < feature->getZoomLevel()) {
+                culled += bucket->end() - feature;
+                break;
+            }
+            
+            const ezgl::rectangle& featureBounds = feature->getBounds();
+            
+            // Cull features off screen, or smaller than a pixel
+            if (featureBounds.right() < visibleWorld.left() || featureBounds.left() > visibleWorld.right()
+                    || featureBounds.top() < visibleWorld.bottom() || featureBounds.bottom() > visibleWorld.top()
+                    || (featureBounds.width() < pixel.x && featureBounds.height() < pixel.y)) {
+                culled++;
+                continue;
+            }
+            
+            const ezgl::point2d* points = &store.FEATURE_POINTS[feature->getPointOffset()];
+            unsigned count = feature->getPointCount();
 
-            if (getFeaturePoint(0, i).lon() == getFeaturePoint(count - 1, i).lon() && getFeaturePoint(0, i).lat() == getFeaturePoint(count - 1, i).lat()) {
+            if (feature->isClosed()) {
                 // Draw closed features
-                
-                std::vector<ezgl::point2d> point;
-                for (int j = 0; j < count; j++) {
-                    point.push_back(ezgl::point2d(lonToX(getFeaturePoint(j, i).lon()), latToY(getFeaturePoint(j, i).lat())));
-                }
-
-                if(store.zoomLevel >= featureIterator->second->getZoomLevel() && point.size() > 1) g.fill_poly(point);
-                
+                g.fill_poly(points, count);
+                drawn++;
             } 
             else {
                 // Draw open features 
-                for (int j = 0; j < count - 1; j++) {
-                    if (store.zoomLevel >= featureIterator->second->getZoomLevel()) g.draw_line({lonToX(getFeaturePoint(j, i).lon()), latToY(getFeaturePoint(j, i).lat())}, 
-                        {lonToX(getFeaturePoint(j+1, i).lon()), latToY(getFeaturePoint(j+1, i).lat())});
+                for (unsigned j = 0; j + 1 < count; j++) {
+                    g.draw_line(points[j], points[j + 1]);
+                    drawn++;
                 }
             }
             
         }
     
     }
+    
+    store.renderProfiler.addCounts(FEATURES_LAYER, drawn, culled);
 }
 
 void drawPointsOfInterest(ezgl::renderer &g) {
     bool shouldDraw = store.zoomLevel <= 7 ? false: true;
+    unsigned drawn = 0, culled = 0;
 
     for (int k = 0; k < getNumPointsOfInterest(); k++) {
         LatLon center = getPointOfInterestPosition(k);
@@ -169,16 +210,23 @@ void drawPointsOfInterest(ezgl::renderer &g) {
             if (type == "hospital" || type == "bank" ||  type == "dentist" || type == "atm" || type == "university") {
                 g.draw_surface(store.PNG_MAP.find(type)->second, {lonToX(center.lon()), latToY(center.lat())});
                 g.draw_text({lonToX(center.lon()), latToY(center.lat())}, name);
+                drawn += 2;
             } 
             else if (type == "fast_food" && store.zoomLevel >= 10) {
                 g.draw_surface(store.PNG_MAP.find(type)->second, {lonToX(center.lon()), latToY(center.lat())});
                 g.draw_text({lonToX(center.lon()), latToY(center.lat())}, name);
+                drawn += 2;
             } 
             else if (store.zoomLevel >= 10) {
                 g.draw_surface(store.PNG_MAP.find("default")->second, {lonToX(center.lon()), latToY(center.lat())});
+                drawn++;
             }
+            else culled++;
         } 
+        else culled++;
     }
+    
+    store.renderProfiler.addCounts(POI_LAYER, drawn, culled);
 }
 
 //draws a marker for highlighted intersections
@@ -188,6 +236,8 @@ void drawHighlighedIntersections(ezgl::renderer &g) {
         LatLon coords = getIntersectionPosition(*it);
         g.draw_surface(store.PNG_MAP.find("marker")->second, {lonToX(coords.lon()), latToY(coords.lat())});
     }
+    
+    store.renderProfiler.addCounts(HIGHLIGHTS_LAYER, store.highlightedIntersections.size(), 0);
 }
 
 //draws a marker for highlighted POIs
@@ -197,6 +247,8 @@ void drawHighlightedPointsOfInterests(ezgl::renderer &g) {
         LatLon coords = getPointOfInterestPosition(*it);
         g.draw_surface(store.PNG_MAP.find("marker")->second, {lonToX(coords.lon()), latToY(coords.lat())});
     }
+    
+    store.renderProfiler.addCounts(HIGHLIGHTS_LAYER, store.highlightedPOIs.size(), 0);
 }
 
 //draws the icon for bus stops
@@ -207,11 +259,16 @@ void drawBusStops(ezgl::renderer &g) {
         for (auto i = points.begin(); i != points.end(); i++) {
             g.draw_surface(store.PNG_MAP.find("bus_stop")->second, {lonToX(i->first.lon()), latToY(i->first.lat())});
         }
+        store.renderProfiler.addCounts(BUS_STOPS_LAYER, points.size(), 0);
     }   
 }
 
-//draws the icon for the user location
+//draws the icon for the user location, once the location is known
 void drawUserLoc(ezgl::renderer &g){
-    g.draw_surface(store.PNG_MAP.find("user_marker")->second, {lonToX(store.userLocation.lon()), latToY(store.userLocation.lat())});
+    LatLon userLocation;
+    if (!store.locationService.getLocation(userLocation)) return;
+    
+    g.draw_surface(store.PNG_MAP.find("user_marker")->second, {lonToX(userLocation.lon()), latToY(userLocation.lat())});
+    store.renderProfiler.addCounts(HIGHLIGHTS_LAYER, 1, 0);
 }
 
@@ -11,6 +11,11 @@ void drawHighlightedPointsOfInterests(ezgl::renderer &g);
 void drawBusStops(ezgl::renderer &g);
 void drawUserLoc(ezgl::renderer &g);
 void drawPath(ezgl::renderer &g);
+void drawIsochrone(ezgl::renderer &g);
+
+// World bounds and headless rendering, see m2.cpp
+ezgl::rectangle getZoomedWorld(ezgl::rectangle initialWorld, ezgl::point2d center, int zoomLevel);
+bool render_map_to_png(std::string pngPath, ezgl::rectangle world, int zoomLevel, int width, int height);
 
 #endif /* REFRESHCALLBACKS_H */
 
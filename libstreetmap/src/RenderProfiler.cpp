@@ -0,0 +1,128 @@
+#include "RenderProfiler.h"
+#include "ReportUtil.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+
+std::string getLayerName(RenderLayer layer) {
+    switch (layer) {
+        case FEATURES_LAYER: return "features";
+        case STREETS_LAYER: return "streets";
+        case ISOCHRONE_LAYER: return "isochrone";
+        case BUS_STOPS_LAYER: return "bus_stops";
+        case POI_LAYER: return "poi";
+        case HIGHLIGHTS_LAYER: return "highlights";
+        case PATH_LAYER: return "path";
+        default: return "unknown";
+    }
+}
+
+void RenderProfiler::startFrame(int zoomLevel) {
+    current = FrameRecord();
+    current.zoomLevel = zoomLevel;
+    inFrame = true;
+    frameStart = Clock::now();
+}
+
+void RenderProfiler::endFrame() {
+    if (!inFrame) return;
+
+    current.frameTime = elapsedMilliseconds(frameStart);
+    inFrame = false;
+
+    // Keep only the rolling window
+    frames.push_back(current);
+    if (frames.size() > PROFILER_FRAME_WINDOW) frames.pop_front();
+}
+
+void RenderProfiler::startLayer(RenderLayer layer) {
+    layerStart[layer] = Clock::now();
+}
+
+void RenderProfiler::endLayer(RenderLayer layer) {
+    if (!inFrame) return;
+    current.layerTimes[layer] += elapsedMilliseconds(layerStart[layer]);
+}
+
+void RenderProfiler::addCounts(RenderLayer layer, unsigned drawn, unsigned culled) {
+    if (!inFrame) return;
+    current.drawnCount[layer] += drawn;
+    current.culledCount[layer] += culled;
+}
+
+/* Nearest-rank percentile of the frame times in the window
+ * @params percentile, between 0 and 100
+ * @returns frame time in ms, 0 if no frames recorded
+ */
+double RenderProfiler::getFramePercentile(double percentile) {
+    if (frames.empty()) return 0;
+
+    std::vector<double> times;
+    for (auto frame = frames.begin(); frame != frames.end(); frame++) {
+        times.push_back(frame->frameTime);
+    }
+
+    unsigned rank = std::min<unsigned>(times.size() - 1, (unsigned)(percentile / 100 * times.size()));
+    std::nth_element(times.begin(), times.begin() + rank, times.end());
+
+    return times[rank];
+}
+
+unsigned RenderProfiler::getFrameCount() {
+    return frames.size();
+}
+
+// Builds a single line summary for the status bar, slowest layer of the last frame is listed first
+std::string RenderProfiler::getSummary() {
+    if (frames.empty()) return "Profiler: no frames recorded";
+
+    const FrameRecord& last = frames.back();
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(1);
+    summary << "frame p50 " << getFramePercentile(50) << "ms p99 " << getFramePercentile(99) << "ms (" << frames.size() << ") |";
+
+    std::vector<int> layers;
+    for (int layer = 0; layer < LAYER_COUNT; layer++) layers.push_back(layer);
+    std::sort(layers.begin(), layers.end(), [&last](int lhs, int rhs) {
+        return last.layerTimes[lhs] > last.layerTimes[rhs];
+    });
+
+    for (auto layer = layers.begin(); layer != layers.end(); layer++) {
+        summary << " " << getLayerName((RenderLayer)*layer) << " " << last.layerTimes[*layer] << "ms "
+                << last.drawnCount[*layer] << "/" << last.culledCount[*layer];
+    }
+
+    return summary.str();
+}
+
+bool RenderProfiler::writeCSV(std::string path) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    // Header
+    file << "frame,zoom_level,frame_ms";
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        std::string name = getLayerName((RenderLayer)layer);
+        file << "," << name << "_ms," << name << "_drawn," << name << "_culled";
+    }
+    file << "\n";
+
+    unsigned index = 0;
+    for (auto frame = frames.begin(); frame != frames.end(); frame++, index++) {
+        file << index << "," << frame->zoomLevel << "," << frame->frameTime;
+        for (int layer = 0; layer < LAYER_COUNT; layer++) {
+            file << "," << frame->layerTimes[layer] << "," << frame->drawnCount[layer] << "," << frame->culledCount[layer];
+        }
+        file << "\n";
+    }
+
+    return true;
+}
+
+void RenderProfiler::reset() {
+    frames.clear();
+    inFrame = false;
+}
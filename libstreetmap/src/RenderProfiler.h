@@ -0,0 +1,72 @@
+/* RenderProfiler times each draw layer of refresh_main_canvas with steady_clock,
+ * and counts the primitives each layer emitted and culled. A rolling window of the
+ * most recent frames is kept for p50/p99 frame times, and can be dumped to a CSV
+ */
+
+#ifndef RENDERPROFILER_H
+#define RENDERPROFILER_H
+
+#include <chrono>
+#include <deque>
+#include <string>
+
+#define PROFILER_FRAME_WINDOW 120
+
+// Draw layers of refresh_main_canvas, in draw order
+enum RenderLayer {
+    FEATURES_LAYER = 0,
+    STREETS_LAYER,
+    ISOCHRONE_LAYER,
+    BUS_STOPS_LAYER,
+    POI_LAYER,
+    HIGHLIGHTS_LAYER,
+    PATH_LAYER,
+    LAYER_COUNT
+};
+
+// Timing and primitive counts of a single refresh
+struct FrameRecord {
+    int zoomLevel = 1;
+    double frameTime = 0;
+    double layerTimes[LAYER_COUNT] = {0};
+    unsigned drawnCount[LAYER_COUNT] = {0};
+    unsigned culledCount[LAYER_COUNT] = {0};
+};
+
+class RenderProfiler {
+public:
+    // Frame and layer timers, layers are only valid between startFrame and endFrame
+    void startFrame(int zoomLevel);
+    void endFrame();
+    void startLayer(RenderLayer layer);
+    void endLayer(RenderLayer layer);
+
+    // Primitive counters, to be called once per layer with the layer's totals
+    void addCounts(RenderLayer layer, unsigned drawn, unsigned culled);
+
+    // Getters
+    double getFramePercentile(double percentile);
+    unsigned getFrameCount();
+    std::string getSummary();
+
+    // Writes every frame in the window as a CSV row, returns false if the file could not be opened
+    bool writeCSV(std::string path);
+
+    void reset();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    bool inFrame = false;
+    Clock::time_point frameStart;
+    Clock::time_point layerStart[LAYER_COUNT];
+    FrameRecord current;
+
+    // Most recent frames, oldest first
+    std::deque<FrameRecord> frames;
+};
+
+// Layer names used in the summary and CSV header
+std::string getLayerName(RenderLayer layer);
+
+#endif /* RENDERPROFILER_H */
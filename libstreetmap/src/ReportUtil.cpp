@@ -0,0 +1,28 @@
+#include "ReportUtil.h"
+
+#include <cstdio>
+
+double elapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string quoteJSON(const std::string& text) {
+    std::string quoted = "\"";
+    for (auto c = text.begin(); c != text.end(); c++) {
+        if (*c == '"' || *c == '\\') {
+            quoted.push_back('\\');
+            quoted.push_back(*c);
+        } else if (*c == '\n') {
+            quoted += "\\n";
+        } else if (*c == '\t') {
+            quoted += "\\t";
+        } else if ((unsigned char)*c < 0x20) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*c);
+            quoted += escaped;
+        } else {
+            quoted.push_back(*c);
+        }
+    }
+    return quoted + "\"";
+}
@@ -0,0 +1,16 @@
+/* Helpers shared by the profilers, load reports and benchmarks that time work and write their results as JSON
+ */
+
+#ifndef REPORTUTIL_H
+#define REPORTUTIL_H
+
+#include <chrono>
+#include <string>
+
+// Milliseconds elapsed since start
+double elapsedMilliseconds(std::chrono::steady_clock::time_point start);
+
+// Quotes text as a JSON string, control characters are escaped
+std::string quoteJSON(const std::string& text);
+
+#endif /* REPORTUTIL_H */
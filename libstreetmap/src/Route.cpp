@@ -15,9 +15,15 @@ int Route::getRouteTag() {
 std::string Route::getRouteName() {
     return routeName;
 }
+long long Route::getStopsFetched() {
+    return stopsFetched;
+}
 
 // Setters
 void Route::setRouteStops(std::vector<std::pair<LatLon, int>> stops) {
     stopPoints = stops;
 }
+void Route::setStopsFetched(long long fetched) {
+    stopsFetched = fetched;
+}
 
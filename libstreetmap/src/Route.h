@@ -13,9 +13,11 @@ public:
     std::vector<std::pair<LatLon, int>> getStopPoints();
     int getRouteTag();
     std::string getRouteName();
+    long long getStopsFetched();
     
     // Setters
     void setRouteStops(std::vector<std::pair<LatLon, int>> stops);
+    void setStopsFetched(long long fetched);
     
     // Public bool for check if already cached bus stops
     bool alreadyBuilt = false;
@@ -24,6 +26,9 @@ private:
     int routeTag;
     std::string routeName;
     std::vector<std::pair<LatLon, int>> stopPoints;
+    
+    // Unix time the stops were downloaded, 0 if not yet
+    long long stopsFetched = 0;
 };
 
 #endif /* ROUTE_H */
@@ -0,0 +1,119 @@
+#include "RouteCache.h"
+#include "m3.h"
+#include "Store.h"
+
+#include <functional>
+
+bool RouteKey::operator==(const RouteKey& other) const {
+    return from == other.from && to == other.to && rightTurnPenalty == other.rightTurnPenalty && leftTurnPenalty == other.leftTurnPenalty;
+}
+
+// Combines the field hashes the same way as boost::hash_combine
+std::size_t RouteKeyHash::operator()(const RouteKey& key) const {
+    std::size_t seed = std::hash<unsigned>()(key.from);
+    seed ^= std::hash<unsigned>()(key.to) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    seed ^= std::hash<double>()(key.rightTurnPenalty) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    seed ^= std::hash<double>()(key.leftTurnPenalty) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+void RouteCache::setMap(std::string identity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (identity == mapIdentity) return;
+
+    mapIdentity = identity;
+    entries.clear();
+    index.clear();
+    segmentCount = 0;
+}
+
+// Counters are kept, they cover every map of the session
+void RouteCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    mapIdentity.clear();
+    entries.clear();
+    index.clear();
+    segmentCount = 0;
+}
+
+bool RouteCache::find(const RouteKey& key, std::vector<unsigned>& path, double& travelTime) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = index.find(key);
+    if (found == index.end()) {
+        misses++;
+        return false;
+    }
+
+    hits++;
+    entries.splice(entries.begin(), entries, found->second);
+    path = found->second->path;
+    travelTime = found->second->travelTime;
+    return true;
+}
+
+void RouteCache::insert(const RouteKey& key, const std::vector<unsigned>& path, double travelTime) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = index.find(key);
+    if (found != index.end()) {
+        segmentCount -= found->second->path.size();
+        entries.erase(found->second);
+        index.erase(found);
+    }
+
+    // A path over the segment bound alone would evict everything and still not fit
+    if (path.size() > ROUTE_CACHE_MAX_SEGMENTS) return;
+
+    entries.push_front(Entry{key, std::vector<unsigned>(path.begin(), path.end()), travelTime});
+    index[key] = entries.begin();
+    segmentCount += path.size();
+
+    while (entries.size() > ROUTE_CACHE_CAPACITY || segmentCount > ROUTE_CACHE_MAX_SEGMENTS) {
+        segmentCount -= entries.back().path.size();
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+std::string RouteCache::getMap() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return mapIdentity;
+}
+
+unsigned long long RouteCache::getHitCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+unsigned long long RouteCache::getMissCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+std::size_t RouteCache::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+// Entries, their paths and the index, list and bucket overheads are estimated
+std::size_t RouteCache::getMemoryUsage() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size() * (sizeof(Entry) + 2 * sizeof(void*)) + segmentCount * sizeof(unsigned)
+            + index.size() * (sizeof(RouteKey) + sizeof(std::list<Entry>::iterator) + sizeof(void*))
+            + index.bucket_count() * sizeof(void*);
+}
+
+std::vector<unsigned> findCachedPath(const unsigned intersect_id_start, const unsigned intersect_id_end,
+        const double right_turn_penalty, const double left_turn_penalty) {
+    RouteKey key = {intersect_id_start, intersect_id_end, right_turn_penalty, left_turn_penalty};
+
+    std::vector<unsigned> path;
+    double travelTime;
+    if (store.routeCache.find(key, path, travelTime)) return path;
+
+    // Searched without the lock, two threads missing on the same key both search and the later insert wins
+    path = find_path_between_intersections(intersect_id_start, intersect_id_end, right_turn_penalty, left_turn_penalty);
+    store.routeCache.insert(key, path, compute_path_travel_time(path, right_turn_penalty, left_turn_penalty));
+    return path;
+}
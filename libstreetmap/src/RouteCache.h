@@ -0,0 +1,89 @@
+/* Route cache, least recently used paths keyed by endpoints and turn penalties
+ * Entries belong to the map the cache was last set to, setting another map drops them all, so a path is never
+ * returned for a map it was not found on. Empty paths are cached as well, a repeated query with no path is a hit
+ * Bounded by entry count and by the total number of cached segments, the least recently used entries go first
+ * Every method locks the cache, so it can be shared by several threads
+ */
+
+#ifndef ROUTECACHE_H
+#define ROUTECACHE_H
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "m3.h"
+
+// Most paths kept at once
+#define ROUTE_CACHE_CAPACITY 4096
+
+// Most segments kept over all paths
+#define ROUTE_CACHE_MAX_SEGMENTS (1 << 20)
+
+struct RouteKey {
+    unsigned from;
+    unsigned to;
+    double rightTurnPenalty;
+    double leftTurnPenalty;
+
+    bool operator==(const RouteKey& other) const;
+};
+
+struct RouteKeyHash {
+    std::size_t operator()(const RouteKey& key) const;
+};
+
+class RouteCache {
+public:
+    // Drops every entry if the identity differs from the map the entries were found on
+    void setMap(std::string identity);
+    void clear();
+
+    /* Looks up a path, a hit makes it the most recently used
+     * @params key, path and travelTime set on a hit
+     * @returns true on a hit
+     */
+    bool find(const RouteKey& key, std::vector<unsigned>& path, double& travelTime);
+
+    // Adds or replaces a path, evicting the least recently used paths past the bounds
+    void insert(const RouteKey& key, const std::vector<unsigned>& path, double travelTime);
+
+    // Getters
+    std::string getMap();
+    unsigned long long getHitCount();
+    unsigned long long getMissCount();
+    std::size_t size();
+    std::size_t getMemoryUsage();
+
+private:
+    struct Entry {
+        RouteKey key;
+
+        // Sized to fit, paths live as long as the cache
+        std::vector<unsigned> path;
+        double travelTime;
+    };
+
+    std::string mapIdentity;
+
+    // Most recently used entry first
+    std::list<Entry> entries;
+    std::unordered_map<RouteKey, std::list<Entry>::iterator, RouteKeyHash> index;
+    std::size_t segmentCount = 0;
+
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    std::mutex mutex;
+};
+
+/* Path from store.routeCache, or from find_path_between_intersections on a miss, which is then cached
+ * Keys hold no engine, so every cached path comes from that one search
+ * @params intersect_id_start, intersect_id_end, right_turn_penalty, left_turn_penalty
+ * @returns segments of the path, empty if there is no path
+ */
+std::vector<unsigned> findCachedPath(const unsigned intersect_id_start, const unsigned intersect_id_end,
+        const double right_turn_penalty, const double left_turn_penalty);
+
+#endif /* ROUTECACHE_H */
@@ -0,0 +1,253 @@
+#include "RoutingOracle.h"
+#include "m1.h"
+#include "m3.h"
+#include "StreetsDatabaseAPI.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+static const char* MISMATCH_NAMES[] = {"illegal path", "reachability mismatch", "cost mismatch", "illegal reference path"};
+
+// An empty path between two different intersections means there is no path, otherwise the path is free
+static double getPathCost(const std::vector<unsigned>& path, const OracleQuery& query) {
+    if (path.empty()) return 0;
+    return compute_path_travel_time(path, query.rightTurnPenalty, query.leftTurnPenalty);
+}
+
+// Intersections a legal path passes through, from included
+static std::vector<unsigned> getPathIntersections(const std::vector<unsigned>& path, unsigned from) {
+    std::vector<unsigned> intersections = {from};
+    for (auto segment = path.begin(); segment != path.end(); segment++) {
+        InfoStreetSegment info = getInfoStreetSegment(*segment);
+        intersections.push_back((unsigned)info.from == intersections.back() ? info.to : info.from);
+    }
+    return intersections;
+}
+
+static std::string describeQuery(const OracleQuery& query) {
+    std::ostringstream description;
+    description << query.from << " -> " << query.to << " (right " << query.rightTurnPenalty << ", left " << query.leftTurnPenalty << ")";
+    return description.str();
+}
+
+std::string getPathError(const std::vector<unsigned>& path, unsigned from, unsigned to) {
+    std::ostringstream error;
+    unsigned current = from;
+
+    for (unsigned index = 0; index < path.size(); index++) {
+        if (path[index] >= (unsigned)getNumStreetSegments()) {
+            error << "segment " << index << " (" << path[index] << ") does not exist";
+            return error.str();
+        }
+
+        InfoStreetSegment info = getInfoStreetSegment(path[index]);
+        if ((unsigned)info.from == current) {
+            current = info.to;
+        } else if ((unsigned)info.to == current && !info.oneWay) {
+            current = info.from;
+        } else if ((unsigned)info.to == current) {
+            error << "segment " << index << " (" << path[index] << ") is one way into intersection " << current;
+            return error.str();
+        } else {
+            error << "segment " << index << " (" << path[index] << ") does not touch intersection " << current;
+            return error.str();
+        }
+    }
+
+    if (current != to) {
+        error << "path ends at intersection " << current << " instead of " << to;
+        return error.str();
+    }
+
+    return "";
+}
+
+std::vector<OracleQuery> generateOracleQueries(unsigned count, unsigned seed, double rightTurnPenalty, double leftTurnPenalty) {
+    std::vector<OracleQuery> queries;
+    if (getNumIntersections() < 2) return queries;
+
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<unsigned> intersection(0, getNumIntersections() - 1);
+
+    while (queries.size() < count) {
+        OracleQuery query;
+        query.from = intersection(random);
+        query.to = intersection(random);
+        query.rightTurnPenalty = rightTurnPenalty;
+        query.leftTurnPenalty = leftTurnPenalty;
+        if (query.from != query.to) queries.push_back(query);
+    }
+
+    return queries;
+}
+
+RoutingOracle::RoutingOracle(std::string name, RoutingEngine routingEngine, double costTolerance) {
+    engineName = name;
+    engine = routingEngine;
+    reference = find_path_between_intersections;
+    tolerance = costTolerance;
+}
+
+void RoutingOracle::setReference(RoutingEngine engineReference) {
+    reference = engineReference;
+}
+
+void RoutingOracle::setAllowCheaper(bool allow) {
+    allowCheaper = allow;
+}
+
+/* Runs the query on both engines without recording anything
+ * @params query, mismatch to fill, cheaper set if the engine found a cheaper path than the reference
+ * @returns false if the engines disagree
+ */
+bool RoutingOracle::compare(const OracleQuery& query, OracleMismatch& mismatch, bool& cheaper) {
+    std::vector<unsigned> referencePath = reference(query.from, query.to, query.rightTurnPenalty, query.leftTurnPenalty);
+    std::vector<unsigned> enginePath = engine(query.from, query.to, query.rightTurnPenalty, query.leftTurnPenalty);
+
+    mismatch.query = query;
+    mismatch.minimalQuery = query;
+    mismatch.referenceCost = getPathCost(referencePath, query);
+    mismatch.engineCost = getPathCost(enginePath, query);
+    cheaper = false;
+
+    std::string error = getPathError(referencePath, query.from, query.to);
+    if (!referencePath.empty() && !error.empty()) {
+        mismatch.type = ILLEGAL_REFERENCE_PATH;
+        mismatch.description = error;
+        return false;
+    }
+
+    error = getPathError(enginePath, query.from, query.to);
+    if (!enginePath.empty() && !error.empty()) {
+        mismatch.type = ILLEGAL_PATH;
+        mismatch.description = error;
+        return false;
+    }
+
+    if (query.from != query.to && referencePath.empty() != enginePath.empty()) {
+        mismatch.type = REACHABILITY_MISMATCH;
+        mismatch.description = referencePath.empty() ? "reference found no path" : "engine found no path";
+        return false;
+    }
+
+    double difference = mismatch.engineCost - mismatch.referenceCost;
+    double limit = tolerance * std::max(1.0, mismatch.referenceCost);
+    cheaper = difference < -limit;
+
+    if (difference > limit || (cheaper && !allowCheaper)) {
+        std::ostringstream description;
+        description << "engine cost " << mismatch.engineCost << "s, reference cost " << mismatch.referenceCost << "s";
+        mismatch.type = COST_MISMATCH;
+        mismatch.description = description.str();
+        return false;
+    }
+
+    return true;
+}
+
+/* Shrinks a failing query, first dropping the turn penalties, then moving the destination and the source
+ * along the path towards each other, as long as the query still fails the same way
+ * @params mismatch
+ * @returns the smallest failing query found
+ */
+OracleQuery RoutingOracle::minimize(const OracleMismatch& mismatch) {
+    auto failsSameWay = [this, &mismatch](const OracleQuery& query) {
+        OracleMismatch result;
+        bool cheaper;
+        return query.from != query.to && !compare(query, result, cheaper) && result.type == mismatch.type;
+    };
+
+    // Path to shrink along, the engine path when the reference found none
+    auto getIntersections = [this](const OracleQuery& query) {
+        std::vector<unsigned> path = reference(query.from, query.to, query.rightTurnPenalty, query.leftTurnPenalty);
+        if (path.empty()) path = engine(query.from, query.to, query.rightTurnPenalty, query.leftTurnPenalty);
+        if (!getPathError(path, query.from, query.to).empty()) path.clear();
+        return getPathIntersections(path, query.from);
+    };
+
+    OracleQuery current = mismatch.query;
+
+    OracleQuery noPenalties = current;
+    noPenalties.rightTurnPenalty = 0;
+    noPenalties.leftTurnPenalty = 0;
+    if ((current.rightTurnPenalty != 0 || current.leftTurnPenalty != 0) && failsSameWay(noPenalties)) current = noPenalties;
+
+    // Closest destination that still fails
+    std::vector<unsigned> intersections = getIntersections(current);
+    for (unsigned index = 1; index + 1 < intersections.size(); index++) {
+        OracleQuery query = current;
+        query.to = intersections[index];
+        if (failsSameWay(query)) {
+            current = query;
+            break;
+        }
+    }
+
+    // Then the source closest to that destination
+    intersections = getIntersections(current);
+    for (unsigned index = intersections.size() - 1; index > 1; index--) {
+        OracleQuery query = current;
+        query.from = intersections[index - 1];
+        if (failsSameWay(query)) {
+            current = query;
+            break;
+        }
+    }
+
+    return current;
+}
+
+bool RoutingOracle::check(const OracleQuery& query) {
+    OracleMismatch mismatch;
+    bool cheaper;
+    queryCount++;
+
+    bool agree = compare(query, mismatch, cheaper);
+    if (cheaper) cheaperCount++;
+    if (agree) return true;
+
+    if (mismatches.size() < ORACLE_MINIMIZED_MISMATCHES) mismatch.minimalQuery = minimize(mismatch);
+    mismatches.push_back(mismatch);
+    return false;
+}
+
+unsigned RoutingOracle::checkAll(const std::vector<OracleQuery>& queries) {
+    unsigned failed = 0;
+    for (auto query = queries.begin(); query != queries.end(); query++) {
+        if (!check(*query)) failed++;
+    }
+    return failed;
+}
+
+std::string RoutingOracle::getName() {
+    return engineName;
+}
+
+unsigned RoutingOracle::getQueryCount() {
+    return queryCount;
+}
+
+unsigned RoutingOracle::getCheaperCount() {
+    return cheaperCount;
+}
+
+std::vector<OracleMismatch> RoutingOracle::getMismatches() {
+    return mismatches;
+}
+
+// One line for the totals, then one line per shrunk mismatch with the query to reproduce it
+std::string RoutingOracle::getSummary() {
+    std::ostringstream summary;
+    summary << engineName << ": " << queryCount << " queries, " << mismatches.size() << " mismatches, "
+            << cheaperCount << " cheaper than the reference\n";
+
+    for (unsigned index = 0; index < mismatches.size() && index < ORACLE_MINIMIZED_MISMATCHES; index++) {
+        const OracleMismatch& mismatch = mismatches[index];
+        summary << "  " << MISMATCH_NAMES[mismatch.type] << " on " << describeQuery(mismatch.query) << ": " << mismatch.description
+                << "\n    reproduce with " << describeQuery(mismatch.minimalQuery) << "\n";
+    }
+
+    return summary.str();
+}
@@ -0,0 +1,98 @@
+/* Differential oracle for routing engines, checks an engine against the reference A* search query by query
+ * Every engine path must be legal (consecutive segments connected, one way segments travelled forward, starting
+ * and ending at the query intersections) and cost the same as the reference path, both costed by
+ * compute_path_travel_time. Reference paths must be legal as well, so a broken reference cannot hide a broken engine
+ * A mismatch is shrunk to a smaller query that still fails, to make it easy to reproduce
+ */
+
+#ifndef ROUTINGORACLE_H
+#define ROUTINGORACLE_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Costs are equal when they differ by at most the tolerance, relative to the reference cost for costs above 1s
+#define ORACLE_DEFAULT_TOLERANCE 1e-6
+
+// Only the first mismatches are shrunk, shrinking runs up to two searches per intersection on the path
+#define ORACLE_MINIMIZED_MISMATCHES 5
+
+struct OracleQuery {
+    unsigned from = 0;
+    unsigned to = 0;
+    double rightTurnPenalty = 0;
+    double leftTurnPenalty = 0;
+};
+
+enum MismatchType {
+    ILLEGAL_PATH = 0,
+    REACHABILITY_MISMATCH,
+    COST_MISMATCH,
+    ILLEGAL_REFERENCE_PATH
+};
+
+struct OracleMismatch {
+    MismatchType type;
+    OracleQuery query;
+
+    // Smallest query found that fails the same way, the query itself when it was not shrunk
+    OracleQuery minimalQuery;
+
+    double referenceCost = 0;
+    double engineCost = 0;
+    std::string description;
+};
+
+// Engine under test, returns the segments of the path from one intersection to another, empty if there is no path
+typedef std::function<std::vector<unsigned>(unsigned from, unsigned to, double rightTurnPenalty, double leftTurnPenalty)> RoutingEngine;
+
+class RoutingOracle {
+public:
+    // The reference engine is find_path_between_intersections
+    RoutingOracle(std::string name, RoutingEngine routingEngine, double costTolerance = ORACLE_DEFAULT_TOLERANCE);
+
+    // Replaces the reference engine, to compare two engines that are not the reference
+    void setReference(RoutingEngine engine);
+
+    // Engines that are exact where the reference is not may find cheaper paths, which are then counted but not mismatches
+    void setAllowCheaper(bool allow);
+
+    // Runs one query on both engines, returns false and records a mismatch if they disagree
+    bool check(const OracleQuery& query);
+
+    // Runs every query, returns the number of mismatches
+    unsigned checkAll(const std::vector<OracleQuery>& queries);
+
+    // Getters
+    std::string getName();
+    unsigned getQueryCount();
+    unsigned getCheaperCount();
+    std::vector<OracleMismatch> getMismatches();
+    std::string getSummary();
+
+private:
+    std::string engineName;
+    RoutingEngine engine;
+    RoutingEngine reference;
+    double tolerance;
+    bool allowCheaper = false;
+
+    unsigned queryCount = 0;
+    unsigned cheaperCount = 0;
+    std::vector<OracleMismatch> mismatches;
+
+    bool compare(const OracleQuery& query, OracleMismatch& mismatch, bool& cheaper);
+    OracleQuery minimize(const OracleMismatch& mismatch);
+};
+
+/* Checks that a path is a legal route between two intersections
+ * @params path segments, from, to
+ * @returns an empty string if the path is legal, otherwise why it is not
+ */
+std::string getPathError(const std::vector<unsigned>& path, unsigned from, unsigned to);
+
+// Seeded random queries with distinct endpoints, all with the same turn penalties
+std::vector<OracleQuery> generateOracleQueries(unsigned count, unsigned seed, double rightTurnPenalty, double leftTurnPenalty);
+
+#endif /* ROUTINGORACLE_H */
@@ -0,0 +1,31 @@
+#include "SearchStats.h"
+
+#include <atomic>
+
+static std::atomic<unsigned long long> totalSearches(0);
+static std::atomic<unsigned long long> totalSettledNodes(0);
+static std::atomic<unsigned long long> totalHeapPushes(0);
+static std::atomic<unsigned long long> totalHeapPops(0);
+
+void recordSearch(const SearchStats& stats) {
+    totalSearches += stats.searches;
+    totalSettledNodes += stats.settledNodes;
+    totalHeapPushes += stats.heapPushes;
+    totalHeapPops += stats.heapPops;
+}
+
+SearchStats getSearchStats() {
+    SearchStats stats;
+    stats.searches = totalSearches;
+    stats.settledNodes = totalSettledNodes;
+    stats.heapPushes = totalHeapPushes;
+    stats.heapPops = totalHeapPops;
+    return stats;
+}
+
+void resetSearchStats() {
+    totalSearches = 0;
+    totalSettledNodes = 0;
+    totalHeapPushes = 0;
+    totalHeapPops = 0;
+}
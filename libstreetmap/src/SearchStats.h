@@ -0,0 +1,23 @@
+/* Counters of the work done by the path searches, for benchmarking routing changes
+ * Each search counts locally and adds its totals once it finishes, so the counters cost nothing per heap
+ * operation and searches running on several threads (traveling_courier) are all counted
+ */
+
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+struct SearchStats {
+    unsigned long long searches = 0;
+    unsigned long long settledNodes = 0;
+    unsigned long long heapPushes = 0;
+    unsigned long long heapPops = 0;
+};
+
+// Adds the counts of one finished search to the totals
+void recordSearch(const SearchStats& stats);
+
+// Totals since the last reset
+SearchStats getSearchStats();
+void resetSearchStats();
+
+#endif /* SEARCHSTATS_H */
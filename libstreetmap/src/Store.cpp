@@ -10,4 +10,6 @@ void Store::resetStore() {
     highlightedPOIs.clear();
     clicked.clear();
     drawPath = false;
+    drawIsochrone = false;
+    isochrone = Isochrone();
 }
@@ -17,6 +17,18 @@
 #include "Route.h"
 #include "Feature.h"
 #include "InternalFeature.h"
+#include "RenderProfiler.h"
+#include "LoadReport.h"
+#include "CourierTrace.h"
+#include "LocationService.h"
+#include "HttpClient.h"
+#include "NameIndex.h"
+#include "TokenIndex.h"
+#include "TurnGraph.h"
+#include "CellOverlay.h"
+#include "RouteCache.h"
+#include "Isochrone.h"
+#include "FacilityIndex.h"
 #include "ezgl/graphics.hpp"
 
 #include <unordered_map>
@@ -34,22 +46,34 @@ public:
     
     std::vector<std::vector<unsigned>> SEGMENTS_IDS;
     
-    //Using multimaps since multiple entries may have the same key 
-    // (constant for each map, caps it easy to relate value to a Store value)
-    std::multimap<std::string, unsigned> STREETS_DICTIONARY;
-    std::multimap<std::string, unsigned> POI_DICTIONARY;
-    std::multimap<OSMID, unsigned> OSMID_SEGMENTID_MAP;
-    std::multimap<FeatureType, InternalFeature*> FEATURES_TYPE_MAP;
-    std::map<std::string, std::vector<unsigned>> INTERSECTION_DICTIONARY;
+    // Directed segments and the turns between them, for routing that is exact with turn penalties
+    TurnGraph turnGraph;
+    CellOverlay cellOverlay;
+
+    // POIs snapped to intersections with a bitmap per POI type, for closest POI by travel time
+    FacilityIndex facilityIndex;
+    
+    // (way OSMID, segment id) of every segment, sorted by OSMID to join the segments with their ways
+    std::vector<std::pair<OSMID, unsigned>> SEGMENT_WAY_IDS;
+    
+    // Street, POI and intersection names, for prefix and exact name search
+    NameIndex NAME_INDEX;
+    TokenIndex INTERSECTION_TOKEN_INDEX;
+    
+    // Features grouped by type, with the buckets in paint order
+    std::vector<std::vector<InternalFeature>> FEATURE_BUCKETS;
+    
+    // Projected feature points of all features, each InternalFeature owns a contiguous range
+    std::vector<ezgl::point2d> FEATURE_POINTS;
     
     // Cached PNG surfaces, unordered_map to acheive constant lookup
     std::unordered_map<std::string, ezgl::surface*> PNG_MAP;
-    std::set<std::string> completionDictionary;
     
     // Map constants
     double LEFT_TURN_PENALTY = 13;
     double RIGHT_TURN_PENALTY = 7;
-    double LAT_AVG;
+    double LAT_AVG = 0;
+    ezgl::rectangle WORLD_BOUNDS = {{0, 0}, {0, 0}};
     
     // Map state data
     bool reloadFlag = false;
@@ -67,7 +91,9 @@ public:
     int zoomLevel = 1;
     int focusedRoute = -1; 
     int focusedBusStop = -1;
-    LatLon userLocation;
+    
+    // User location, looked up in the background and kept across map loads
+    LocationService locationService;
     
     // Clicked Intersections
     std::vector<unsigned> clicked;
@@ -75,16 +101,34 @@ public:
     // Live data
     std::map<int, Route*> routes;
     
-    // libcurl response buffer
-    std::string responseBuffer = "";
+    // Unix time the route list was downloaded, see BusCache
+    long long busRoutesFetched = 0;
+    
+    // Background requests of the network commands
+    HttpClient httpClient;
 
     // direction/path related
     std::vector<unsigned> path;
+    RouteCache routeCache;
     bool drawPath = false;
+
+    // isochrone related
+    Isochrone isochrone;
+    bool drawIsochrone = false;
     double topSpeedLimit = 0;
     
     // help commands
     std::vector<std::string> commands;
+    
+    // render profiling, toggled with /profile
+    bool profilingFlag = false;
+    RenderProfiler renderProfiler;
+    
+    // Phase timings and container sizes of the last load_map
+    LoadReport loadReport;
+    
+    // Phase timings and improvements of the last traveling_courier
+    CourierTrace courierTrace;
 };
 
 extern Store store;
@@ -0,0 +1,140 @@
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+unsigned getWorkerCount() {
+    unsigned workers = std::thread::hardware_concurrency();
+    return workers == 0 ? 1 : workers;
+}
+
+TaskID TaskGraph::addTask(std::string name, std::function<void()> work, std::vector<TaskID> dependencies) {
+    TaskID id = tasks.size();
+
+    Task task;
+    task.name = name;
+    task.work = work;
+    task.dependencyCount = dependencies.size();
+    tasks.push_back(task);
+
+    for (auto dependency = dependencies.begin(); dependency != dependencies.end(); dependency++) {
+        tasks[*dependency].dependents.push_back(id);
+    }
+
+    return id;
+}
+
+TaskID TaskGraph::addParallelTask(std::string name, unsigned count, unsigned chunkCount,
+        std::function<void(unsigned begin, unsigned end, unsigned chunk)> work, std::vector<TaskID> dependencies) {
+    if (chunkCount == 0) chunkCount = 1;
+
+    std::vector<TaskID> chunks;
+    for (unsigned chunk = 0; chunk < chunkCount; chunk++) {
+        // Even split, the first count % chunkCount chunks get one extra index
+        unsigned begin = (unsigned long long)count * chunk / chunkCount;
+        unsigned end = (unsigned long long)count * (chunk + 1) / chunkCount;
+
+        chunks.push_back(addTask(name + " " + std::to_string(chunk), [work, begin, end, chunk]() {
+            work(begin, end, chunk);
+        }, dependencies));
+    }
+
+    TaskID join = addTask(name, []() {}, chunks);
+    tasks[join].chunks = chunks;
+
+    return join;
+}
+
+void TaskGraph::run(unsigned threadCount) {
+    if (threadCount == 0) threadCount = 1;
+
+    std::mutex mutex;
+    std::condition_variable readyCondition;
+    std::queue<TaskID> ready;
+    std::vector<unsigned> remaining(tasks.size());
+    unsigned finished = 0;
+    std::exception_ptr firstException;
+    std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now();
+    auto elapsed = [runStart]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+    };
+
+    for (TaskID id = 0; id < tasks.size(); id++) {
+        remaining[id] = tasks[id].dependencyCount;
+        if (remaining[id] == 0) ready.push(id);
+    }
+
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            readyCondition.wait(lock, [&]() { return !ready.empty() || finished == tasks.size(); });
+            if (ready.empty()) return;
+
+            TaskID id = ready.front();
+            ready.pop();
+
+            lock.unlock();
+            tasks[id].startTime = elapsed();
+            try {
+                tasks[id].work();
+            } catch (...) {
+                std::lock_guard<std::mutex> exceptionLock(mutex);
+                if (!firstException) firstException = std::current_exception();
+            }
+            tasks[id].endTime = elapsed();
+            lock.lock();
+
+            // Release the dependents whose last dependency this was
+            finished++;
+            for (auto dependent = tasks[id].dependents.begin(); dependent != tasks[id].dependents.end(); dependent++) {
+                if (--remaining[*dependent] == 0) ready.push(*dependent);
+            }
+            readyCondition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threadCount; i++) workers.push_back(std::thread(worker));
+
+    // The calling thread works as well
+    worker();
+
+    for (auto thread = workers.begin(); thread != workers.end(); thread++) thread->join();
+    runTime = elapsed();
+
+    if (firstException) std::rethrow_exception(firstException);
+}
+
+unsigned TaskGraph::getTaskCount() {
+    return tasks.size();
+}
+
+std::string TaskGraph::getTaskName(TaskID id) {
+    return tasks[id].name;
+}
+
+std::vector<TaskID> TaskGraph::getChunks(TaskID id) {
+    return tasks[id].chunks;
+}
+
+double TaskGraph::getStartTime(TaskID id) {
+    double start = tasks[id].startTime;
+    for (auto chunk = tasks[id].chunks.begin(); chunk != tasks[id].chunks.end(); chunk++) {
+        start = std::min(start, tasks[*chunk].startTime);
+    }
+    return start;
+}
+
+double TaskGraph::getEndTime(TaskID id) {
+    return tasks[id].endTime;
+}
+
+double TaskGraph::getRunTime() {
+    return runTime;
+}
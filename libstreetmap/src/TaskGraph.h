@@ -0,0 +1,59 @@
+/* TaskGraph runs a set of tasks with dependencies on a pool of worker threads
+ * A task starts once every task it depends on has finished, independent tasks run concurrently
+ * Loops are split with addParallelTask into one task per chunk of the index range, joined by a single task
+ */
+
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+typedef unsigned TaskID;
+
+class TaskGraph {
+public:
+    // Adds a task, dependencies must already be in the graph
+    TaskID addTask(std::string name, std::function<void()> work, std::vector<TaskID> dependencies = std::vector<TaskID>());
+
+    // Splits [0, count) into chunkCount ranges, work is called once per range with the chunk index
+    // Returns the task that finishes once every chunk has finished
+    TaskID addParallelTask(std::string name, unsigned count, unsigned chunkCount,
+            std::function<void(unsigned begin, unsigned end, unsigned chunk)> work, std::vector<TaskID> dependencies = std::vector<TaskID>());
+
+    // Runs every task and blocks until all have finished
+    // Rethrows the first exception thrown by a task, after the remaining tasks have run
+    void run(unsigned threadCount);
+
+    // Getters
+    unsigned getTaskCount();
+    std::string getTaskName(TaskID id);
+
+    // Chunk tasks of a parallel task, empty for other tasks
+    std::vector<TaskID> getChunks(TaskID id);
+
+    // Start and end of a task in ms since the last run started
+    // A parallel task spans from the start of its first chunk to the end of its last chunk
+    double getStartTime(TaskID id);
+    double getEndTime(TaskID id);
+    double getRunTime();
+
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> work;
+        std::vector<TaskID> dependents;
+        std::vector<TaskID> chunks;
+        unsigned dependencyCount = 0;
+        double startTime = 0, endTime = 0;
+    };
+
+    std::vector<Task> tasks;
+    double runTime = 0;
+};
+
+// Number of worker threads to use, at least one
+unsigned getWorkerCount();
+
+#endif /* TASKGRAPH_H */
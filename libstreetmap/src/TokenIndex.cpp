@@ -0,0 +1,150 @@
+#include "TokenIndex.h"
+
+#include <algorithm>
+#include <cctype>
+
+std::vector<std::string> tokenizeName(std::string name) {
+    std::vector<std::string> nameTokens;
+    std::string token;
+
+    for (auto it = name.begin(); it != name.end(); it++) {
+        unsigned char c = *it;
+        if (std::isalnum(c)) {
+            token.push_back(std::tolower(c));
+        } else if (!token.empty()) {
+            nameTokens.push_back(token);
+            token.clear();
+        }
+    }
+    if (!token.empty()) nameTokens.push_back(token);
+
+    return nameTokens;
+}
+
+/* Intersects sorted list with sorted other, galloping through other since list is expected to be the shorter one
+ * @params sorted list, sorted range [other, otherEnd)
+ * @returns the ids in both
+ */
+static std::vector<unsigned> intersectSorted(const std::vector<unsigned>& list, const unsigned* other, const unsigned* otherEnd) {
+    std::vector<unsigned> common;
+
+    for (auto it = list.begin(); it != list.end() && other != otherEnd; it++) {
+        // Double the step until passing the id, then binary search the last step
+        std::size_t step = 1;
+        while (other + step < otherEnd && other[step] < *it) step *= 2;
+
+        const unsigned* end = other + std::min<std::size_t>(step + 1, otherEnd - other);
+        other = std::lower_bound(other + step / 2, end, *it);
+
+        if (other != otherEnd && *other == *it) common.push_back(*it);
+    }
+
+    return common;
+}
+
+void TokenIndex::insert(std::string name, unsigned id) {
+    insert(std::vector<std::pair<std::string, unsigned>>(1, std::make_pair(name, id)));
+}
+
+void TokenIndex::insert(const std::vector<std::pair<std::string, unsigned>>& names) {
+    std::vector<std::pair<std::string, unsigned>> tokenIDs;
+    for (auto name = names.begin(); name != names.end(); name++) {
+        std::vector<std::string> nameTokens = tokenizeName(name->first);
+
+        for (auto token = nameTokens.begin(); token != nameTokens.end(); token++) {
+            tokenIDs.push_back(std::make_pair(*token, name->second));
+        }
+    }
+
+    // One lock per batch
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.insert(pending.end(), tokenIDs.begin(), tokenIDs.end());
+}
+
+void TokenIndex::build() {
+    std::sort(pending.begin(), pending.end());
+    pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+
+    tokens.clear();
+    postingOffsets.clear();
+    postings.clear();
+    postings.reserve(pending.size());
+
+    for (auto it = pending.begin(); it != pending.end(); it++) {
+        if (tokens.empty() || tokens.back() != it->first) {
+            tokens.push_back(it->first);
+            postingOffsets.push_back(postings.size());
+        }
+        postings.push_back(it->second);
+    }
+    postingOffsets.push_back(postings.size());
+
+    std::vector<std::pair<std::string, unsigned>>().swap(pending);
+}
+
+std::vector<unsigned> TokenIndex::find(std::string query) {
+    std::vector<unsigned> ids;
+
+    std::vector<std::string> queryTokens = tokenizeName(query);
+    if (queryTokens.empty() || tokens.empty()) return ids;
+
+    // Postings range of each exact query token
+    std::vector<std::pair<const unsigned*, const unsigned*>> lists;
+    for (unsigned i = 0; i + 1 < queryTokens.size(); i++) {
+        auto token = std::lower_bound(tokens.begin(), tokens.end(), queryTokens[i]);
+        if (token == tokens.end() || *token != queryTokens[i]) return ids;
+
+        unsigned index = token - tokens.begin();
+        lists.push_back(std::make_pair(&postings[postingOffsets[index]], &postings[0] + postingOffsets[index + 1]));
+    }
+
+    // Last token is a prefix, so merge the postings of every token starting with it
+    const std::string& prefix = queryTokens.back();
+    std::vector<unsigned> prefixIds;
+    for (auto token = std::lower_bound(tokens.begin(), tokens.end(), prefix); token != tokens.end(); token++) {
+        if (token->compare(0, prefix.size(), prefix) != 0) break;
+
+        unsigned index = token - tokens.begin();
+        prefixIds.insert(prefixIds.end(), postings.begin() + postingOffsets[index], postings.begin() + postingOffsets[index + 1]);
+    }
+    std::sort(prefixIds.begin(), prefixIds.end());
+    prefixIds.erase(std::unique(prefixIds.begin(), prefixIds.end()), prefixIds.end());
+    if (prefixIds.empty()) return ids;
+
+    // Intersect smallest first, so every step is bounded by the shortest list so far
+    std::sort(lists.begin(), lists.end(), [](const std::pair<const unsigned*, const unsigned*>& lhs, const std::pair<const unsigned*, const unsigned*>& rhs) {
+        return lhs.second - lhs.first < rhs.second - rhs.first;
+    });
+
+    ids = prefixIds;
+    if (!lists.empty() && (std::size_t)(lists.front().second - lists.front().first) < ids.size()) {
+        ids.assign(lists.front().first, lists.front().second);
+        lists.front() = std::make_pair(&prefixIds[0], &prefixIds[0] + prefixIds.size());
+    }
+
+    for (auto list = lists.begin(); list != lists.end() && !ids.empty(); list++) {
+        ids = intersectSorted(ids, list->first, list->second);
+    }
+
+    return ids;
+}
+
+unsigned TokenIndex::size() {
+    return tokens.size();
+}
+
+std::size_t TokenIndex::getMemoryUsage() {
+    std::size_t bytes = tokens.capacity() * sizeof(std::string);
+    for (auto token = tokens.begin(); token != tokens.end(); token++) bytes += token->capacity();
+
+    return bytes + (postingOffsets.capacity() + postings.capacity()) * sizeof(unsigned);
+}
+
+void TokenIndex::clear() {
+    tokens.clear();
+    postingOffsets.clear();
+    postings.clear();
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.clear();
+}
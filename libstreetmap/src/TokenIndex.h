@@ -0,0 +1,46 @@
+/* TokenIndex is an inverted index from the lowercase alphanumeric tokens of names to sorted id postings
+ * A query matches the ids whose name contains every query token, with the last query token matched
+ * as a prefix so partially typed words still match. Postings are intersected smallest first by galloping
+ */
+
+#ifndef TOKENINDEX_H
+#define TOKENINDEX_H
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TokenIndex {
+public:
+    // Thread safe, only valid before build
+    void insert(std::string name, unsigned id);
+    void insert(const std::vector<std::pair<std::string, unsigned>>& names);
+
+    // Packs the inserted tokens into the postings arrays, to be called once all names are inserted
+    void build();
+
+    // Sorted ids matching every token of query
+    std::vector<unsigned> find(std::string query);
+
+    unsigned size();
+    void clear();
+
+    // Bytes held by the tokens and postings
+    std::size_t getMemoryUsage();
+
+private:
+    // Sorted unique tokens, the postings of tokens[i] are postings[postingOffsets[i], postingOffsets[i + 1])
+    std::vector<std::string> tokens;
+    std::vector<unsigned> postingOffsets;
+    std::vector<unsigned> postings;
+
+    // Token and id pairs waiting for build
+    std::vector<std::pair<std::string, unsigned>> pending;
+    std::mutex pendingMutex;
+};
+
+// Lowercase alphanumeric runs of name
+std::vector<std::string> tokenizeName(std::string name);
+
+#endif /* TOKENINDEX_H */
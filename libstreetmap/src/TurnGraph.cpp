@@ -0,0 +1,300 @@
+#include "TurnGraph.h"
+#include "SearchStats.h"
+#include "util.h"
+#include "Store.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <queue>
+
+unsigned TurnSearchWorkspace::startSearch(unsigned edgeCount) {
+    // Stale best times are told apart by generation, they are only cleared when the generation wraps around
+    if (bestTimes.size() != edgeCount || generation == UINT_MAX) {
+        bestTimes.assign(edgeCount, 0);
+        reachingEdges.assign(edgeCount, NO_EDGE);
+        visited.assign(edgeCount, 0);
+        generation = 0;
+    }
+    return ++generation;
+}
+
+unsigned getForwardEdge(unsigned segment) {
+    return 2 * segment;
+}
+
+unsigned getBackwardEdge(unsigned segment) {
+    return 2 * segment + 1;
+}
+
+void TurnGraph::prepare() {
+    unsigned segmentCount = getNumStreetSegments();
+    unsigned intersectionCount = getNumIntersections();
+
+    edgeHeads.assign(2 * segmentCount, 0);
+    edgeTimes.assign(2 * segmentCount, 0);
+    std::vector<bool> valid(2 * segmentCount, false);
+
+    for (unsigned segment = 0; segment < segmentCount; segment++) {
+        InfoStreetSegment info = getInfoStreetSegment(segment);
+        double travelTime = store.SEGMENTS[segment]->getTravelTime();
+
+        edgeHeads[getForwardEdge(segment)] = info.to;
+        edgeTimes[getForwardEdge(segment)] = travelTime;
+        valid[getForwardEdge(segment)] = true;
+
+        edgeHeads[getBackwardEdge(segment)] = info.from;
+        edgeTimes[getBackwardEdge(segment)] = travelTime;
+        valid[getBackwardEdge(segment)] = !info.oneWay;
+    }
+
+    outgoingOffsets.assign(intersectionCount + 1, 0);
+    outgoingEdges.clear();
+    for (unsigned intersection = 0; intersection < intersectionCount; intersection++) {
+        const std::vector<unsigned>& segments = store.SEGMENTS_IDS[intersection];
+        for (auto segment = segments.begin(); segment != segments.end(); segment++) {
+            InfoStreetSegment info = getInfoStreetSegment(*segment);
+            if ((unsigned)info.from == intersection) outgoingEdges.push_back(getForwardEdge(*segment));
+            if ((unsigned)info.to == intersection && !info.oneWay) outgoingEdges.push_back(getBackwardEdge(*segment));
+        }
+        outgoingOffsets[intersection + 1] = outgoingEdges.size();
+    }
+
+    // A directed segment can turn onto every directed segment leaving its head, a backward one way segment is never entered
+    arcOffsets.assign(2 * segmentCount + 1, 0);
+    for (unsigned edge = 0; edge < 2 * segmentCount; edge++) {
+        unsigned head = edgeHeads[edge];
+        unsigned turns = valid[edge] ? outgoingOffsets[head + 1] - outgoingOffsets[head] : 0;
+        arcOffsets[edge + 1] = arcOffsets[edge] + turns;
+    }
+
+    arcTargets.assign(arcOffsets.back(), 0);
+    arcTurns.assign(arcOffsets.back(), (unsigned char)TurnType::NONE);
+
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    metrics.clear();
+}
+
+void TurnGraph::buildArcs(unsigned begin, unsigned end) {
+    for (unsigned edge = begin; edge < end; edge++) {
+        unsigned arc = arcOffsets[edge];
+        if (arc == arcOffsets[edge + 1]) continue;
+
+        unsigned head = edgeHeads[edge];
+        for (unsigned outgoing = outgoingOffsets[head]; outgoing < outgoingOffsets[head + 1]; outgoing++, arc++) {
+            unsigned target = outgoingEdges[outgoing];
+            arcTargets[arc] = target;
+            arcTurns[arc] = (unsigned char)find_turn_type(edge / 2, target / 2);
+        }
+    }
+}
+
+void TurnGraph::clear() {
+    edgeHeads.clear();
+    edgeTimes.clear();
+    outgoingOffsets.clear();
+    outgoingEdges.clear();
+    arcOffsets.clear();
+    arcTargets.clear();
+    arcTurns.clear();
+
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    metrics.clear();
+}
+
+TurnMetric TurnGraph::customize(double rightTurnPenalty, double leftTurnPenalty) const {
+    TurnMetric metric;
+    metric.rightTurnPenalty = rightTurnPenalty;
+    metric.leftTurnPenalty = leftTurnPenalty;
+    metric.arcCosts.resize(arcTargets.size());
+
+    #pragma omp parallel for
+    for (unsigned arc = 0; arc < arcTargets.size(); arc++) {
+        double penalty = 0;
+        switch ((TurnType)arcTurns[arc]) {
+            case TurnType::LEFT: penalty = leftTurnPenalty; break;
+            case TurnType::RIGHT: penalty = rightTurnPenalty; break;
+            default: penalty = 0; break;
+        }
+        metric.arcCosts[arc] = edgeTimes[arcTargets[arc]] + penalty;
+    }
+
+    return metric;
+}
+
+std::shared_ptr<const TurnMetric> TurnGraph::getMetric(double rightTurnPenalty, double leftTurnPenalty) {
+    std::lock_guard<std::mutex> lock(metricsMutex);
+
+    for (auto metric = metrics.begin(); metric != metrics.end(); metric++) {
+        if ((*metric)->rightTurnPenalty != rightTurnPenalty || (*metric)->leftTurnPenalty != leftTurnPenalty) continue;
+
+        // Move to the back, most recently used
+        std::shared_ptr<const TurnMetric> found = *metric;
+        metrics.erase(metric);
+        metrics.push_back(found);
+        return found;
+    }
+
+    std::shared_ptr<const TurnMetric> metric = std::make_shared<const TurnMetric>(customize(rightTurnPenalty, leftTurnPenalty));
+    if (metrics.size() == TURN_METRIC_CACHE_SIZE) metrics.erase(metrics.begin());
+    metrics.push_back(metric);
+    return metric;
+}
+
+std::vector<unsigned> TurnGraph::findPath(unsigned from, unsigned to, const TurnMetric& metric, TurnSearchWorkspace& workspace) const {
+    std::vector<unsigned> path;
+    if (from == to || from + 1 >= outgoingOffsets.size() || to + 1 >= outgoingOffsets.size()) return path;
+
+    unsigned generation = workspace.startSearch(edgeHeads.size());
+
+    SearchStats stats;
+    stats.searches = 1;
+
+    std::priority_queue<TurnWave, std::vector<TurnWave>, std::greater<TurnWave>> wavefront;
+
+    auto reach = [&](unsigned edge, double time, int reachingEdge) {
+        if (workspace.visited[edge] == generation && workspace.bestTimes[edge] <= time) return;
+
+        workspace.visited[edge] = generation;
+        workspace.bestTimes[edge] = time;
+        workspace.reachingEdges[edge] = reachingEdge;
+        wavefront.push(TurnWave{time + heuristic(edgeHeads[edge], to), time, edge});
+        stats.heapPushes++;
+    };
+
+    for (unsigned outgoing = outgoingOffsets[from]; outgoing < outgoingOffsets[from + 1]; outgoing++) {
+        reach(outgoingEdges[outgoing], edgeTimes[outgoingEdges[outgoing]], NO_EDGE);
+    }
+
+    int found = NO_EDGE;
+    while (!wavefront.empty()) {
+        TurnWave wave = wavefront.top();
+        wavefront.pop();
+        stats.heapPops++;
+
+        // Skip entries left behind by a cheaper arrival
+        unsigned edge = wave.edge;
+        double time = wave.travelTime;
+        if (time > workspace.bestTimes[edge]) continue;
+        stats.settledNodes++;
+
+        if (edgeHeads[edge] == to) {
+            found = edge;
+            break;
+        }
+
+        for (unsigned arc = arcOffsets[edge]; arc < arcOffsets[edge + 1]; arc++) {
+            reach(arcTargets[arc], time + metric.arcCosts[arc], edge);
+        }
+    }
+    recordSearch(stats);
+
+    for (int edge = found; edge != NO_EDGE; edge = workspace.reachingEdges[edge]) path.push_back(edge / 2);
+    std::reverse(path.begin(), path.end());
+
+    return path;
+}
+
+unsigned TurnGraph::searchAll(unsigned from, const TurnMetric& metric, TurnSearchWorkspace& workspace, double timeLimit,
+        const SettleCallback& settled) const {
+    unsigned generation = workspace.startSearch(edgeHeads.size());
+    if (from + 1 >= outgoingOffsets.size()) return generation;
+
+    SearchStats stats;
+    stats.searches = 1;
+
+    std::priority_queue<TurnWave, std::vector<TurnWave>, std::greater<TurnWave>> wavefront;
+
+    // Arrivals past the limit are never recorded, so the heap only ever holds directed segments in reach
+    auto reach = [&](unsigned edge, double time, int reachingEdge) {
+        if (time > timeLimit) return;
+        if (workspace.visited[edge] == generation && workspace.bestTimes[edge] <= time) return;
+
+        workspace.visited[edge] = generation;
+        workspace.bestTimes[edge] = time;
+        workspace.reachingEdges[edge] = reachingEdge;
+        wavefront.push(TurnWave{time, time, edge});
+        stats.heapPushes++;
+    };
+
+    for (unsigned outgoing = outgoingOffsets[from]; outgoing < outgoingOffsets[from + 1]; outgoing++) {
+        reach(outgoingEdges[outgoing], edgeTimes[outgoingEdges[outgoing]], NO_EDGE);
+    }
+
+    const unsigned* targets = arcTargets.data();
+    const double* costs = metric.arcCosts.data();
+    while (!wavefront.empty()) {
+        TurnWave wave = wavefront.top();
+        wavefront.pop();
+        stats.heapPops++;
+
+        unsigned edge = wave.edge;
+        double time = wave.travelTime;
+        if (time > workspace.bestTimes[edge]) continue;
+        stats.settledNodes++;
+
+        if (settled && !settled(edge, time)) break;
+
+        for (unsigned arc = arcOffsets[edge]; arc < arcOffsets[edge + 1]; arc++) {
+            reach(targets[arc], time + costs[arc], edge);
+        }
+    }
+    recordSearch(stats);
+
+    return generation;
+}
+
+unsigned TurnGraph::getEdgeCount() const {
+    return edgeHeads.size();
+}
+
+unsigned TurnGraph::getArcCount() const {
+    return arcTargets.size();
+}
+
+unsigned TurnGraph::getEdgeHead(unsigned edge) const {
+    return edgeHeads[edge];
+}
+
+double TurnGraph::getEdgeTime(unsigned edge) const {
+    return edgeTimes[edge];
+}
+
+// Graph arrays only, metrics are counted by their owners
+std::size_t TurnGraph::getMemoryUsage() const {
+    return edgeHeads.capacity() * sizeof(unsigned) + edgeTimes.capacity() * sizeof(double)
+            + (outgoingOffsets.capacity() + outgoingEdges.capacity() + arcOffsets.capacity() + arcTargets.capacity()) * sizeof(unsigned)
+            + arcTurns.capacity();
+}
+
+std::vector<unsigned> TurnGraph::getOutgoingEdges(unsigned intersection) const {
+    return std::vector<unsigned>(outgoingEdges.begin() + outgoingOffsets[intersection], outgoingEdges.begin() + outgoingOffsets[intersection + 1]);
+}
+
+unsigned TurnGraph::getArcBegin(unsigned edge) const {
+    return arcOffsets[edge];
+}
+
+unsigned TurnGraph::getArcEnd(unsigned edge) const {
+    return arcOffsets[edge + 1];
+}
+
+unsigned TurnGraph::getArcTarget(unsigned arc) const {
+    return arcTargets[arc];
+}
+
+TurnType TurnGraph::getArcTurn(unsigned arc) const {
+    return (TurnType)arcTurns[arc];
+}
+
+const std::vector<unsigned>& TurnGraph::getArcTargets() const {
+    return arcTargets;
+}
+
+std::vector<unsigned> findTurnExactPath(const unsigned intersect_id_start, const unsigned intersect_id_end,
+        const double right_turn_penalty, const double left_turn_penalty) {
+    static thread_local TurnSearchWorkspace workspace;
+
+    std::shared_ptr<const TurnMetric> metric = store.turnGraph.getMetric(right_turn_penalty, left_turn_penalty);
+    return store.turnGraph.findPath(intersect_id_start, intersect_id_end, *metric, workspace);
+}
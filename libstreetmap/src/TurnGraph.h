@@ -0,0 +1,136 @@
+/* Turn expanded (edge based) search graph, for routing that is exact with turn penalties
+ * Every node is a street segment travelled in one direction, and every arc a turn from one directed segment onto
+ * a directed segment leaving the intersection it ends at. Directed segment 2s travels segment s from -> to,
+ * 2s + 1 travels it to -> from and has no arcs when s is one way
+ * Turn types are found once per map with find_turn_type, so they match compute_path_travel_time exactly
+ * A TurnMetric turns them into arc costs for one pair of turn penalties, so a search pays one array read per arc
+ * Graph and metrics are read only once built, so searches can run on several threads, each with its own workspace
+ */
+
+#ifndef TURNGRAPH_H
+#define TURNGRAPH_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "m3.h"
+
+// Metrics kept for the most recently used penalty pairs
+#define TURN_METRIC_CACHE_SIZE 4
+
+// Arc costs of a graph for one pair of turn penalties, the travel time of the segment turned onto plus the turn penalty
+struct TurnMetric {
+    double rightTurnPenalty = 0;
+    double leftTurnPenalty = 0;
+    std::vector<double> arcCosts;
+};
+
+// Search state of one thread, reused across searches so nothing is cleared or allocated per search
+struct TurnSearchWorkspace {
+    std::vector<double> bestTimes;
+    std::vector<int> reachingEdges;
+
+    // Search that last set each edge's best time, edges from older searches are unvisited
+    std::vector<unsigned> visited;
+    unsigned generation = 0;
+
+    // Sizes the workspace for a graph and starts a new generation, returns it
+    unsigned startSearch(unsigned edgeCount);
+};
+
+// Called on every directed segment a search settles with its travel time, returning false stops the search
+typedef std::function<bool(unsigned edge, double travelTime)> SettleCallback;
+
+// Wavefront entry of a search over directed segments, ordered by estimated total time
+struct TurnWave {
+    double estimatedTime;
+    double travelTime;
+    unsigned edge;
+
+    bool operator>(const TurnWave& other) const {
+        return estimatedTime > other.estimatedTime;
+    }
+};
+
+class TurnGraph {
+public:
+    // Sizes the graph and its directed segments, needs store.SEGMENTS and store.SEGMENTS_IDS
+    void prepare();
+
+    // Finds the turns out of directed segments [begin, end), ranges can be built concurrently once prepared
+    void buildArcs(unsigned begin, unsigned end);
+
+    void clear();
+
+    // Arc costs for a penalty pair, customized on first use and cached
+    std::shared_ptr<const TurnMetric> getMetric(double rightTurnPenalty, double leftTurnPenalty);
+    TurnMetric customize(double rightTurnPenalty, double leftTurnPenalty) const;
+
+    /* A* over the directed segments, with the straight line heuristic of searchPath
+     * @params intersection from, intersection to, metric, workspace of the calling thread
+     * @returns segments of the cheapest path by compute_path_travel_time, empty if there is none
+     */
+    std::vector<unsigned> findPath(unsigned from, unsigned to, const TurnMetric& metric, TurnSearchWorkspace& workspace) const;
+
+    /* Dijkstra from an intersection to every directed segment reachable within timeLimit, no target and no heuristic
+     * Directed segments are settled in order of travel time. Once the search runs to the end, the directed segments
+     * visited in the returned generation hold their final travel times in bestTimes, every other one is out of reach
+     * @params intersection from, metric, workspace of the calling thread, timeLimit in seconds, settled callback
+     * @returns generation of the search
+     */
+    unsigned searchAll(unsigned from, const TurnMetric& metric, TurnSearchWorkspace& workspace, double timeLimit,
+            const SettleCallback& settled = nullptr) const;
+
+    // Getters
+    unsigned getEdgeCount() const;
+    unsigned getArcCount() const;
+    unsigned getEdgeHead(unsigned edge) const;
+    double getEdgeTime(unsigned edge) const;
+    std::size_t getMemoryUsage() const;
+
+    // Directed segments leaving an intersection
+    std::vector<unsigned> getOutgoingEdges(unsigned intersection) const;
+
+    // Turns out of a directed segment, as indices into the arc arrays and the metric's arc costs
+    unsigned getArcBegin(unsigned edge) const;
+    unsigned getArcEnd(unsigned edge) const;
+    unsigned getArcTarget(unsigned arc) const;
+    TurnType getArcTurn(unsigned arc) const;
+
+    // Target of every arc, for searches that walk many arcs
+    const std::vector<unsigned>& getArcTargets() const;
+
+private:
+    // Intersection each directed segment ends at and its travel time
+    std::vector<unsigned> edgeHeads;
+    std::vector<double> edgeTimes;
+
+    // Directed segments leaving intersection i are outgoingEdges[outgoingOffsets[i], outgoingOffsets[i + 1])
+    std::vector<unsigned> outgoingOffsets;
+    std::vector<unsigned> outgoingEdges;
+
+    // Turns out of directed segment e are arcs [arcOffsets[e], arcOffsets[e + 1])
+    std::vector<unsigned> arcOffsets;
+    std::vector<unsigned> arcTargets;
+    std::vector<unsigned char> arcTurns;
+
+    // Most recently used metric last
+    std::vector<std::shared_ptr<const TurnMetric>> metrics;
+    std::mutex metricsMutex;
+};
+
+// Directed segments of a segment
+unsigned getForwardEdge(unsigned segment);
+unsigned getBackwardEdge(unsigned segment);
+
+/* Path search backend over store.turnGraph, exact with turn penalties unlike searchPath
+ * Safe to call from several threads at once, each thread keeps its own workspace
+ * @params intersect_id_start, intersect_id_end, right_turn_penalty, left_turn_penalty
+ * @returns segments of the path, empty if there is no path
+ */
+std::vector<unsigned> findTurnExactPath(const unsigned intersect_id_start, const unsigned intersect_id_end,
+        const double right_turn_penalty, const double left_turn_penalty);
+
+#endif /* TURNGRAPH_H */
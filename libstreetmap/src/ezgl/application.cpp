@@ -1,4 +1,5 @@
 #include "ezgl/application.hpp"
+#include "../util.h"
 #include <set>
 
 // A flag to disable event loop (default is false)
@@ -204,20 +205,23 @@ void application::register_default_buttons_callbacks(ezgl::application *applicat
 //  g_signal_connect(zoom_fit_button, "clicked", G_CALLBACK(press_zoom_fit), application);
 }
 
-void application::initializeAutoComplete() {
-    // Populate the completion model that was init during load_map
-    for (auto entry = store.completionDictionary.begin(); entry != store.completionDictionary.end(); entry++) {
-        //first search bar
-        GtkTreeIter iterator1;
-        gtk_list_store_append(GTK_LIST_STORE(get_object("completionModel1")), &iterator1);
-        gtk_list_store_set(GTK_LIST_STORE(get_object("completionModel1")), &iterator1, 0, (*entry).c_str(), -1);
-
-        //second search bar
-        GtkTreeIter iterator2;
-        gtk_list_store_append(GTK_LIST_STORE(get_object("completionModel2")), &iterator2);
-        gtk_list_store_set(GTK_LIST_STORE(get_object("completionModel2")), &iterator2, 0, (*entry).c_str(), -1);
+// Refills a search bar's completion model with the top completions of its text, on every edit
+static void update_completion(GtkEditable *editable, gpointer user_data) {
+    GtkListStore *model = GTK_LIST_STORE(user_data);
+    std::vector<std::string> completions = getCompletions(gtk_entry_get_text(GTK_ENTRY(editable)));
+    
+    gtk_list_store_clear(model);
+    for (auto entry = completions.begin(); entry != completions.end(); entry++) {
+        GtkTreeIter iterator;
+        gtk_list_store_append(model, &iterator);
+        gtk_list_store_set(model, &iterator, 0, (*entry).c_str(), -1);
     }
-  
+}
+
+void application::initializeAutoComplete() {
+    // Search bar is completed from completionModel2, destination bar from completionModel1
+    g_signal_connect(get_object("SearchBox"), "changed", G_CALLBACK(update_completion), get_object("completionModel2"));
+    g_signal_connect(get_object("Destination"), "changed", G_CALLBACK(update_completion), get_object("completionModel1"));
 }
 
     void application::update_status(std::string const &message)
@@ -425,6 +429,17 @@ void application::initializeAutoComplete() {
         gtk_widget_show_all((GtkWidget *)card);
     }
     
+    void application::createSuggestionCard(std::string const &query, std::vector<std::string> const &suggestions){
+        resetCards();
+        
+        GtkBox *detailBox = (GtkBox *)get_object("DetailBox");
+        
+        GtkWidget* card = createCard("No exact match", "for \"" + query + "\"", "Did you mean", suggestions);
+        gtk_box_pack_start(detailBox, (GtkWidget *)card, true, true, 10);
+
+        gtk_widget_show_all((GtkWidget *)card);
+    }
+    
     void application::refresh_drawing()
     {
       // get the main canvas
@@ -163,7 +163,7 @@ public:
    */
   void update_status(std::string const &message);
   
-  // Initalize the autocomplete for the two search bars
+  // Initalize the autocomplete for the two search bars, completions are looked up as the user types
   void initializeAutoComplete();
   
   /* Resets all the cards current in the DetailBox BoxWidget */
@@ -217,6 +217,13 @@ public:
    * Creates a standard card for displaying an error was received
    */  
   void createErrorCard(std::string message);
+  
+    /* 
+   * Creates a standard card listing the closest matches of a search with no exact match
+   * @param query, the user's search
+   * @param suggestions, best match first
+   */  
+  void createSuggestionCard(std::string const &query, std::vector<std::string> const &suggestions);
 
   /**
    * Gets input from SearchBox widget
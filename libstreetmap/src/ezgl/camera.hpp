@@ -74,8 +74,9 @@ public:
   }
 
 protected:
-  // Only an ezgl::canvas can create a camera.
+  // Only an ezgl::canvas (or headless_canvas) can create a camera.
   friend class canvas;
+  friend class headless_canvas;
 
   /**
    * Create a camera.
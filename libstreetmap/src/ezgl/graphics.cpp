@@ -12,6 +12,12 @@ renderer::renderer(cairo_t *cairo,
     : m_cairo(cairo), m_transform(std::move(transform)), m_camera(p_camera), rotation_angle(0)
 {
 #ifdef EZGL_USE_X11
+  // Off-screen image surfaces (e.g. headless rendering) have no x11 drawable, draw with cairo only
+  x11_enabled = cairo_surface_get_type(m_surface) == CAIRO_SURFACE_TYPE_XLIB;
+  transparency_flag = !x11_enabled;
+  if(!x11_enabled)
+    return;
+
   // get the underlying x11 drawable used by cairo surface
   x11_drawable = cairo_xlib_surface_get_drawable(m_surface);
 
@@ -31,7 +37,8 @@ renderer::~renderer()
 {
 #ifdef EZGL_USE_X11
   // free the x11 context
-  XFreeGC(x11_display, x11_context);
+  if(x11_enabled)
+    XFreeGC(x11_display, x11_context);
 #endif
 }
 
@@ -57,6 +64,11 @@ rectangle renderer::get_visible_world()
   return {(world.bottom_left() - margin), (world.top_right() + margin)};
 }
 
+point2d renderer::get_world_scale_factor()
+{
+  return m_camera->get_world_scale_factor();
+}
+
 bool renderer::rectangle_off_screen(rectangle rect)
 {
   if(current_coordinate_system == SCREEN)
@@ -98,6 +110,9 @@ void renderer::set_color(uint_fast8_t red,
   cairo_set_source_rgba(m_cairo, red / 255.0, green / 255.0, blue / 255.0, alpha / 255.0);
 
 #ifdef EZGL_USE_X11
+  if(!x11_enabled)
+    return;
+
   // check transparency
   if(alpha != 255)
     transparency_flag = true;
@@ -121,9 +136,10 @@ void renderer::set_line_cap(line_cap cap)
 
 #ifdef EZGL_USE_X11
   current_line_cap = cap;
-  XSetLineAttributes(x11_display, x11_context, current_line_width,
-      current_line_dash == line_dash::none ? LineSolid : LineOnOffDash,
-      current_line_cap == line_cap::butt ? CapButt : CapRound, JoinMiter);
+  if(x11_enabled)
+    XSetLineAttributes(x11_display, x11_context, current_line_width,
+        current_line_dash == line_dash::none ? LineSolid : LineOnOffDash,
+        current_line_cap == line_cap::butt ? CapButt : CapRound, JoinMiter);
 #endif
 }
 
@@ -142,9 +158,10 @@ void renderer::set_line_dash(line_dash dash)
 
 #ifdef EZGL_USE_X11
   current_line_dash = dash;
-  XSetLineAttributes(x11_display, x11_context, current_line_width,
-      current_line_dash == line_dash::none ? LineSolid : LineOnOffDash,
-      current_line_cap == line_cap::butt ? CapButt : CapRound, JoinMiter);
+  if(x11_enabled)
+    XSetLineAttributes(x11_display, x11_context, current_line_width,
+        current_line_dash == line_dash::none ? LineSolid : LineOnOffDash,
+        current_line_cap == line_cap::butt ? CapButt : CapRound, JoinMiter);
 #endif
 }
 
@@ -154,9 +171,10 @@ void renderer::set_line_width(int width)
 
 #ifdef EZGL_USE_X11
   current_line_width = width;
-  XSetLineAttributes(x11_display, x11_context, current_line_width,
-      current_line_dash == line_dash::none ? LineSolid : LineOnOffDash,
-      current_line_cap == line_cap::butt ? CapButt : CapRound, JoinMiter);
+  if(x11_enabled)
+    XSetLineAttributes(x11_display, x11_context, current_line_width,
+        current_line_dash == line_dash::none ? LineSolid : LineOnOffDash,
+        current_line_cap == line_cap::butt ? CapButt : CapRound, JoinMiter);
 #endif
 }
 
@@ -277,13 +295,20 @@ void renderer::fill_poly(std::vector<point2d> const &points)
 {
   assert(points.size() > 1);
 
+  fill_poly(points.data(), points.size());
+}
+
+void renderer::fill_poly(point2d const *points, std::size_t count)
+{
+  assert(count > 1);
+
   // Conservative but fast clip test -- check containing rectangle of polygon
   double x_min = points[0].x;
   double x_max = points[0].x;
   double y_min = points[0].y;
   double y_max = points[0].y;
 
-  for(std::size_t i = 1; i < points.size(); ++i) {
+  for(std::size_t i = 1; i < count; ++i) {
     x_min = std::min(x_min, points[i].x);
     x_max = std::max(x_max, points[i].x);
     y_min = std::min(y_min, points[i].y);
@@ -300,11 +325,11 @@ void renderer::fill_poly(std::vector<point2d> const &points)
     XPoint fixed_trans_points[X11_MAX_FIXED_POLY_PTS];
     XPoint *trans_points = fixed_trans_points;
 
-    if(points.size() > X11_MAX_FIXED_POLY_PTS) {
-      trans_points = new XPoint[points.size()];
+    if(count > X11_MAX_FIXED_POLY_PTS) {
+      trans_points = new XPoint[count];
     }
 
-    for(size_t i = 0; i < points.size(); i++) {
+    for(size_t i = 0; i < count; i++) {
       if(current_coordinate_system == WORLD)
         next_point = m_transform(points[i]);
       else
@@ -313,10 +338,10 @@ void renderer::fill_poly(std::vector<point2d> const &points)
       trans_points[i].y = static_cast<long>(next_point.y);
     }
 
-    XFillPolygon(x11_display, x11_drawable, x11_context, trans_points, points.size(), Complex,
+    XFillPolygon(x11_display, x11_drawable, x11_context, trans_points, count, Complex,
         CoordModeOrigin);
 
-    if(points.size() > X11_MAX_FIXED_POLY_PTS)
+    if(count > X11_MAX_FIXED_POLY_PTS)
       delete[] trans_points;
     return;
   }
@@ -327,7 +352,7 @@ void renderer::fill_poly(std::vector<point2d> const &points)
 
   cairo_move_to(m_cairo, next_point.x, next_point.y);
 
-  for(std::size_t i = 1; i < points.size(); ++i) {
+  for(std::size_t i = 1; i < count; ++i) {
     if(current_coordinate_system == WORLD)
       next_point = m_transform(points[i]);
     else
@@ -156,6 +156,11 @@ public:
    */
   rectangle get_visible_world();
 
+  /**
+   * Get the size of one screen pixel in world coordinates
+   */
+  point2d get_world_scale_factor();
+
   /**** Functions to set graphics attributes (for all subsequent drawing calls). ****/
 
   /**
@@ -309,6 +314,14 @@ public:
    */
   void fill_poly(std::vector<point2d> const &points);
 
+  /**
+   * Draw a filled polygon from a contiguous array of points, e.g. a slice of a larger point buffer.
+   *
+   * @param points The points to draw. The first and last points are connected to close the polygon.
+   * @param count The number of points, must be greater than 1.
+   */
+  void fill_poly(point2d const *points, std::size_t count);
+
   /**
    * Draw the outline of an elliptic arc.
    *
@@ -407,8 +420,9 @@ public:
   ~renderer();
 
 protected:
-  // Only the canvas class can create a renderer.
+  // Only the canvas classes can create a renderer.
   friend class canvas;
+  friend class headless_canvas;
 
   /**
    * A callback for transforming points from one coordinate system to another.
@@ -463,6 +477,9 @@ private:
 
   // Transparency flag, if set cairo will be used
   bool transparency_flag = false;
+
+  // Whether the target surface is an x11 surface, false for off-screen image surfaces
+  bool x11_enabled = false;
 #endif
 
   transform_fn m_transform;
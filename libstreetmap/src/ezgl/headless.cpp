@@ -0,0 +1,55 @@
+#include "ezgl/headless.hpp"
+
+#include <functional>
+
+namespace ezgl {
+
+headless_canvas::headless_canvas(draw_canvas_fn draw_callback, rectangle coordinate_system, int width, int height)
+    : m_draw_callback(draw_callback), m_camera(coordinate_system)
+{
+  m_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+  m_camera.update_widget(width, height);
+}
+
+headless_canvas::~headless_canvas()
+{
+  if(m_surface != nullptr) {
+    cairo_surface_destroy(m_surface);
+  }
+}
+
+int headless_canvas::width() const
+{
+  return cairo_image_surface_get_width(m_surface);
+}
+
+int headless_canvas::height() const
+{
+  return cairo_image_surface_get_height(m_surface);
+}
+
+void headless_canvas::redraw()
+{
+  cairo_t *context = cairo_create(m_surface);
+
+  // Match the on-screen canvas so images are comparable
+  cairo_set_antialias(context, CAIRO_ANTIALIAS_NONE);
+
+  // Clear the image.
+  cairo_set_source_rgb(context, 1, 1, 1);
+  cairo_paint(context);
+
+  using namespace std::placeholders;
+  renderer g(context, std::bind(&camera::world_to_screen, m_camera, _1), &m_camera, m_surface);
+  if(m_draw_callback != nullptr)
+    m_draw_callback(g);
+
+  cairo_destroy(context);
+  cairo_surface_flush(m_surface);
+}
+
+bool headless_canvas::write_png(std::string const &file_path)
+{
+  return cairo_surface_write_to_png(m_surface, file_path.c_str()) == CAIRO_STATUS_SUCCESS;
+}
+}
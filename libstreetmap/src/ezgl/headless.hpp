@@ -0,0 +1,89 @@
+#ifndef EZGL_HEADLESS_HPP
+#define EZGL_HEADLESS_HPP
+
+#include <ezgl/camera.hpp>
+#include <ezgl/canvas.hpp>
+#include <ezgl/rectangle.hpp>
+#include <ezgl/graphics.hpp>
+
+#include <cairo.h>
+
+#include <string>
+
+namespace ezgl {
+
+/**
+ * An off-screen canvas that renders to a cairo image surface.
+ *
+ * Unlike ezgl::canvas, a headless_canvas does not need a GtkDrawingArea, a display or a running GTK event loop. The
+ * same draw callback used by an on-screen canvas can be invoked on it, and the result written out as a PNG. This
+ * makes rendering usable from batch jobs and benchmarks on machines without a display.
+ */
+class headless_canvas {
+public:
+  /**
+   * Create an off-screen canvas.
+   *
+   * @param draw_callback The function to call that draws to this canvas.
+   * @param coordinate_system The world region that is visible on the canvas.
+   * @param width The width of the image in pixels.
+   * @param height The height of the image in pixels.
+   */
+  headless_canvas(draw_canvas_fn draw_callback, rectangle coordinate_system, int width, int height);
+
+  /**
+   * Destructor.
+   */
+  ~headless_canvas();
+
+  /**
+   * Copies are disabled.
+   */
+  headless_canvas(headless_canvas const &) = delete;
+
+  /**
+   * Copies are disabled.
+   */
+  headless_canvas &operator=(headless_canvas const &) = delete;
+
+  /**
+   * Invoke the draw callback on the image surface.
+   */
+  void redraw();
+
+  /**
+   * Write the current contents of the image surface to a PNG.
+   *
+   * @param file_path The path of the PNG to create.
+   *
+   * @return Whether the PNG was written successfully.
+   */
+  bool write_png(std::string const &file_path);
+
+  int width() const;
+
+  int height() const;
+
+  camera const &get_camera() const
+  {
+    return m_camera;
+  }
+
+  camera &get_camera()
+  {
+    return m_camera;
+  }
+
+private:
+  // The function to call when the canvas needs to be redrawn.
+  draw_canvas_fn m_draw_callback;
+
+  // The transformations between the image and the world.
+  camera m_camera;
+
+  // The off-screen image surface that is drawn to.
+  cairo_surface_t *m_surface = nullptr;
+};
+}
+
+#endif //EZGL_HEADLESS_HPP
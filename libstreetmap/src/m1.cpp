@@ -26,10 +26,11 @@
 #include "m1.h"
 #include "util.h"
 #include "Build.h"
+#include "TaskGraph.h"
 
 #include <math.h>
-#include <thread>
 #include <set>
+#include <unordered_set>
 
 // Init global store
 Store store;
@@ -37,14 +38,76 @@ Store store;
 // Flag for close_map to check if the map was loaded
 bool loadedSuccessfully;
 
+// Estimated bytes owned by a vector of values
+template <typename T>
+static std::size_t getVectorBytes(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+// Estimated bytes owned by a vector of pointers, with one T per pointer
+template <typename T>
+static std::size_t getPointerVectorBytes(const std::vector<T*>& values) {
+    return values.capacity() * sizeof(T*) + values.size() * sizeof(T);
+}
+
+/* Adds the size of every Store container built by load_map to the load report
+ * Bytes are the container storage and the objects it points to, not the heap memory owned by those objects
+ * @params none
+ * @returns void
+ */
+static void reportStoreContainers() {
+    LoadReport& report = store.loadReport;
+    
+    report.addContainer("INTERSECTIONS", store.INTERSECTIONS.size(), getPointerVectorBytes(store.INTERSECTIONS));
+    report.addContainer("STREETS", store.STREETS.size(), getPointerVectorBytes(store.STREETS));
+    report.addContainer("SEGMENTS", store.SEGMENTS.size(), getPointerVectorBytes(store.SEGMENTS));
+    report.addContainer("intersectionSearchNodes", store.intersectionSearchNodes.size(), getPointerVectorBytes(store.intersectionSearchNodes));
+    
+    std::size_t segmentIDs = 0, segmentIDBytes = getVectorBytes(store.SEGMENTS_IDS);
+    for (auto ids = store.SEGMENTS_IDS.begin(); ids != store.SEGMENTS_IDS.end(); ids++) {
+        segmentIDs += ids->size();
+        segmentIDBytes += getVectorBytes(*ids);
+    }
+    report.addContainer("SEGMENTS_IDS", segmentIDs, segmentIDBytes);
+    
+    report.addContainer("TURN_GRAPH", store.turnGraph.getArcCount(), store.turnGraph.getMemoryUsage());
+    report.addContainer("CELL_OVERLAY", store.cellOverlay.getShortcutCount(), store.cellOverlay.getMemoryUsage());
+    report.addContainer("FACILITY_INDEX", store.facilityIndex.getCategoryCount(), store.facilityIndex.getMemoryUsage());
+    report.addContainer("SEGMENT_WAY_IDS", store.SEGMENT_WAY_IDS.size(), getVectorBytes(store.SEGMENT_WAY_IDS));
+    report.addContainer("NAME_INDEX", store.NAME_INDEX.size(), store.NAME_INDEX.getMemoryUsage());
+    report.addContainer("INTERSECTION_TOKEN_INDEX", store.INTERSECTION_TOKEN_INDEX.size(), store.INTERSECTION_TOKEN_INDEX.getMemoryUsage());
+    
+    std::size_t features = 0, featureBytes = getVectorBytes(store.FEATURE_BUCKETS);
+    for (auto bucket = store.FEATURE_BUCKETS.begin(); bucket != store.FEATURE_BUCKETS.end(); bucket++) {
+        features += bucket->size();
+        featureBytes += getVectorBytes(*bucket);
+    }
+    report.addContainer("FEATURE_BUCKETS", features, featureBytes);
+    report.addContainer("FEATURE_POINTS", store.FEATURE_POINTS.size(), getVectorBytes(store.FEATURE_POINTS));
+}
+
 bool load_map(std::string map_name) {
    
     // Build map paths for osm
     std::string main_path = map_name.substr(0, map_name.find("."));
     std::string map_OSM_path = main_path + ".osm.bin";
 
+    LoadReport& report = store.loadReport;
+    report.start(map_name);
+
     // Initialize Database API
-    if(!loadStreetsDatabaseBIN(map_name) || !loadOSMDatabaseBIN(map_OSM_path)) return false; 
+    report.startPhase("streets database");
+    bool streetsLoaded = loadStreetsDatabaseBIN(map_name);
+    report.endPhase();
+    if (!streetsLoaded) return false;
+    
+    // Cached routes stay valid across reloads of the same map
+    store.routeCache.setMap(map_name + " " + std::to_string(getNumIntersections()) + " " + std::to_string(getNumStreetSegments()));
+    
+    report.startPhase("osm database");
+    bool osmLoaded = loadOSMDatabaseBIN(map_OSM_path);
+    report.endPhase();
+    if (!osmLoaded) return false;
     
     store.STREETS.resize(getNumStreets());
     store.SEGMENTS.resize(getNumStreetSegments());
@@ -52,25 +115,89 @@ bool load_map(std::string map_name) {
     store.intersectionSearchNodes.resize(getNumIntersections());
     store.SEGMENTS_IDS.resize(getNumIntersections());
     
-    store.userLocation = getUserLatLon();
+    // User location is looked up in the background while the map builds, drawUserLoc draws it once found
+    bool standInLocation = useStandInLocation();
+    if (!standInLocation) store.locationService.start(fetchIPLocation);
     
     buildCommandList();
     
-    // Build threads
-    std::thread t1(buildIntersectionsVector);
-    std::thread t2(buildFeatureMap);
-    std::thread t3(buildPOIDictionary);
-    std::thread t4(buildCompletionDictionary);
+    // Load is a task graph, every loop is split into one chunk per worker
+    // Chunk results are merged in order, so the store is the same for any number of workers
+    unsigned workers = getWorkerCount();
+    std::vector<SegmentChunk> segmentChunks(workers);
+    std::vector<StreetChunk> streetChunks(workers);
+    std::vector<FeatureChunk> featureChunks(workers);
+    
+    TaskGraph load;
+    
+    // Projection is needed by the segment rotation angles and the feature build
+    TaskID bounds = load.addTask("map bounds", buildMapBounds);
+    
+    TaskID intersections = load.addParallelTask("intersections", getNumIntersections(), workers, 
+            [](unsigned begin, unsigned end, unsigned) { buildIntersectionsVector(begin, end); });
+    
+    TaskID segments = load.addParallelTask("street segments", getNumStreetSegments(), workers, 
+            [&](unsigned begin, unsigned end, unsigned chunk) { buildStreetSegments(begin, end, segmentChunks[chunk]); }, {bounds});
+    TaskID segmentsMerge = load.addTask("street segments merge", [&]() { mergeStreetSegments(segmentChunks); }, {segments});
+    
+    TaskID streetLists = load.addParallelTask("street segment lists", getNumStreetSegments(), workers, 
+            [&](unsigned begin, unsigned end, unsigned chunk) { buildStreetSegmentLists(begin, end, streetChunks[chunk]); });
+    TaskID streetsMerge = load.addTask("streets merge", [&]() { mergeStreets(streetChunks); }, {streetLists});
+    TaskID streets = load.addParallelTask("streets", getNumStreets(), workers, 
+            [](unsigned begin, unsigned end, unsigned) { buildStreets(begin, end); }, {streetsMerge, segments});
     
-    buildStreetSegments();
-    buildStreets();
-    buildOSMWays();
+    // Turn types come from find_turn_type, which reads the segment curve points
+    TaskID turnGraph = load.addTask("turn graph", []() { store.turnGraph.prepare(); }, {intersections, segments});
+    TaskID turnArcs = load.addParallelTask("turn graph arcs", 2 * getNumStreetSegments(), workers, 
+            [](unsigned begin, unsigned end, unsigned) { store.turnGraph.buildArcs(begin, end); }, {turnGraph});
     
-    // Wait for threads to finish
-    t1.join();
-    t2.join();
-    t3.join();
-    t4.join();
+    // Cell graphs are made of the turn arcs, penalty pairs are customized on first use
+    load.addTask("cell overlay", []() { store.cellOverlay.build(); }, {turnArcs});
+    
+    load.addParallelTask("osm ways", getNumberOfWays(), workers, 
+            [](unsigned begin, unsigned end, unsigned) { buildOSMWays(begin, end); }, {segmentsMerge});
+    
+    TaskID pois = load.addParallelTask("poi names", getNumPointsOfInterest(), workers, 
+            [](unsigned begin, unsigned end, unsigned) { buildPOIDictionary(begin, end); });
+    
+    // Reads positions and types straight from the streets database, so it runs alongside everything else
+    load.addTask("facility index", []() { store.facilityIndex.build(); });
+    
+    TaskID features = load.addParallelTask("features", getNumFeatures(), workers, 
+            [&](unsigned begin, unsigned end, unsigned chunk) { buildFeatureMap(begin, end, featureChunks[chunk]); }, {bounds});
+    TaskID featuresMerge = load.addTask("features merge", [&]() { mergeFeatureMap(featureChunks); }, {features});
+    load.addParallelTask("feature sort", FEATURE_BUCKET_COUNT, FEATURE_BUCKET_COUNT, 
+            [](unsigned begin, unsigned end, unsigned) { sortFeatureBuckets(begin, end); }, {featuresMerge});
+    
+    // Search indexes, once every name is inserted
+    load.addTask("name index", []() { store.NAME_INDEX.build(); }, {intersections, streets, pois});
+    load.addTask("intersection token index", []() { store.INTERSECTION_TOKEN_INDEX.build(); }, {intersections});
+    
+    // The whole graph is one phase including the thread joins, each task is also reported on its own
+    // Tasks run concurrently, so only the whole graph has a peak RSS delta
+    report.startPhase("load graph");
+    load.run(workers);
+    report.endPhase();
+    
+    double graphStart = report.getPhases().back().startTime;
+    std::unordered_set<TaskID> chunks;
+    for (TaskID id = 0; id < load.getTaskCount(); id++) {
+        std::vector<TaskID> taskChunks = load.getChunks(id);
+        chunks.insert(taskChunks.begin(), taskChunks.end());
+    }
+    for (TaskID id = 0; id < load.getTaskCount(); id++) {
+        if (chunks.count(id)) continue;
+        report.addPhase(load.getTaskName(id), graphStart + load.getStartTime(id), load.getEndTime(id) - load.getStartTime(id));
+    }
+    
+    // Offline, the user is placed at the stand-in location, or the center of the map
+    if (standInLocation) {
+        ezgl::point2d center = store.WORLD_BOUNDS.center();
+        store.locationService.setLocation(getStandInLatLon(LatLon(yToLat(center.y), xToLon(center.x))));
+    }
+    
+    reportStoreContainers();
+    report.finish();
     
     // Safety flag for close_map
     loadedSuccessfully = true;
@@ -95,10 +222,6 @@ void close_map() {
         delete store.SEGMENTS[street_id];
     }
     
-    for (auto it = store.FEATURES_TYPE_MAP.begin(); it != store.FEATURES_TYPE_MAP.end(); it++) {
-        delete it->second;
-    }
-    
     for (auto it = store.routes.begin(); it != store.routes.end(); it++) {
         delete it->second;
     }
@@ -107,16 +230,25 @@ void close_map() {
         ezgl::renderer::free_surface(it->second);
     }
     
+    // Network workers must finish before curl is cleaned up
+    store.locationService.stop();
+    store.httpClient.stop();
+    
     store.PNG_MAP.clear();
     store.newMapLoadFlag = true;
-    store.STREETS_DICTIONARY.clear();
-    store.OSMID_SEGMENTID_MAP.clear();
-    store.FEATURES_TYPE_MAP.clear();
+    store.NAME_INDEX.clear();
+    store.INTERSECTION_TOKEN_INDEX.clear();
+    store.SEGMENT_WAY_IDS.clear();
+    store.FEATURE_BUCKETS.clear();
+    store.FEATURE_POINTS.clear();
     store.routes.clear();
+    store.busRoutesFetched = 0;
     store.commands.clear();
-    store.completionDictionary.clear();
     store.clicked.clear();
     store.SEGMENTS_IDS.clear();
+    store.turnGraph.clear();
+    store.cellOverlay.clear();
+    store.facilityIndex.clear();
 
     // Close Databases
     closeStreetDatabase();    
@@ -227,15 +359,6 @@ std::vector<unsigned> find_street_ids_from_partial_street_name(std::string stree
     std::vector<unsigned> street_ids;
     if (street_prefix.length() == 0) return street_ids;
     
-    // Sanitize input to be lowercase
-    std::transform(street_prefix.begin(), street_prefix.end(), street_prefix.begin(), ::tolower);
-
-    auto lowerbound = store.STREETS_DICTIONARY.lower_bound(street_prefix);
-
-    for (auto it = lowerbound; it != store.STREETS_DICTIONARY.end(); it++) {
-        if (it->first.find(street_prefix) == std::string::npos) break;
-        street_ids.push_back(it->second);
-    }
-
-    return street_ids;
+    // Name index is case insensitive
+    return store.NAME_INDEX.findPrefix(street_prefix, STREET_ENTITY);
 }
@@ -13,6 +13,7 @@
 #include <string>
 #include <ezgl/application.hpp>
 #include <ezgl/graphics.hpp>
+#include <ezgl/headless.hpp>
 
 void act_on_mouse_press(ezgl::application *application, GdkEventButton *event, double x, double y);
 void act_on_key_press(ezgl::application *application, GdkEventKey *event, char *key_name);
@@ -24,26 +25,35 @@ void act_on_mouse_move(ezgl::application *application, GdkEventButton *event, do
 // Refresh Callback
 void refresh_main_canvas(ezgl::renderer &g);
 
-void draw_map() {
-    
-    //used to determine initial bounds of the world
-    double lat_min = getIntersectionPosition(1).lat();
-    double lat_max = lat_min;
-    double lon_min = getIntersectionPosition(1).lon();
-    double lon_max = lon_min;
-    
-    for (int i = 0; i < getNumIntersections(); i++) {
-        LatLon coords = getIntersectionPosition(i);
-        
-        if (lat_min > coords.lat()) lat_min = coords.lat();
-        if (lat_max < coords.lat()) lat_max = coords.lat();
-        if (lon_min > coords.lon()) lon_min = coords.lon();
-        if (lon_max < coords.lon()) lon_max = coords.lon();
-    }
+// Application of the current draw_map, set once initial_setup is called
+// Used by refresh_main_canvas to report profiler results on the status bar
+ezgl::application *mainApplication = nullptr;
+
+// GTK timeout that waits for the user location lookup, 0 when not waiting
+guint userLocationSource = 0;
+
+// Runs the callbacks of completed requests, scheduled on the GTK main loop by store.httpClient
+static gboolean deliverHttpResponses(gpointer data) {
+    (void) data;
+    store.httpClient.deliver();
+    return G_SOURCE_REMOVE;
+}
+
+/* Polled on the GTK main loop until the background user location lookup finishes
+ * @params application to redraw once the location is found
+ * @returns whether to keep polling
+ */
+static gboolean checkUserLocation(gpointer data) {
+    LocationState state = store.locationService.getState();
+    if (state == LOCATION_PENDING) return G_SOURCE_CONTINUE;
     
-    store.LAT_AVG = (lat_min + lat_max)/2 * DEG_TO_RAD;
-    ezgl::rectangle initial_world{{lonToX(lon_min), latToY(lat_min)}, {lonToX(lon_max), latToY(lat_max)}};
+    if (state == LOCATION_READY) static_cast<ezgl::application*>(data)->refresh_drawing();
     
+    userLocationSource = 0;
+    return G_SOURCE_REMOVE;
+}
+
+void draw_map() {
     ezgl::application::settings settings;
     settings.main_ui_resource = "./libstreetmap/resources/main.ui";
     // Note: the "main.ui" file has a GtkWindow called "MainWindow".
@@ -52,10 +62,47 @@ void draw_map() {
     settings.canvas_identifier = "MainCanvas";
     
     ezgl::application application(settings);
-    application.add_canvas("MainCanvas", refresh_main_canvas, initial_world);
+    application.add_canvas("MainCanvas", refresh_main_canvas, store.WORLD_BOUNDS);
+    
+    // Network responses are handled on the main loop, since their callbacks update the GUI
+    store.httpClient.setNotify([]() { g_idle_add(deliverHttpResponses, nullptr); });
     
     
     application.run(initial_setup, act_on_mouse_press, act_on_mouse_move, act_on_key_press);
+    mainApplication = nullptr;
+    
+    // The application is gone, so stop waiting on the location and responses for it
+    if (userLocationSource != 0) g_source_remove(userLocationSource);
+    userLocationSource = 0;
+    store.httpClient.cancelAll();
+    store.httpClient.setNotify(nullptr);
+}
+
+/* Gets the visible world at a zoom level, matching what the GUI shows after the initial zoom
+ * and (zoomLevel - 1) scroll zooms of DEFAULT_ZOOM_SCALE around center
+ * @params initial world, center of the view in world coordinates, zoomLevel
+ * @returns the visible world rectangle
+ */
+ezgl::rectangle getZoomedWorld(ezgl::rectangle initialWorld, ezgl::point2d center, int zoomLevel) {
+    double scale = pow(DEFAULT_ZOOM_SCALE, zoomLevel);
+    double width = initialWorld.width() / scale;
+    double height = initialWorld.height() / scale;
+    
+    return ezgl::rectangle({center.x - width / 2, center.y - height / 2}, width, height);
+}
+
+/* Renders the map to a PNG through refresh_main_canvas without starting GTK
+ * The map must already be loaded
+ * @params pngPath, world (visible region), zoomLevel (controls which layers are drawn), image size in pixels
+ * @returns whether the PNG was written
+ */
+bool render_map_to_png(std::string pngPath, ezgl::rectangle world, int zoomLevel, int width, int height) {
+    store.zoomLevel = zoomLevel;
+    
+    ezgl::headless_canvas canvas(refresh_main_canvas, world, width, height);
+    canvas.redraw();
+    
+    return canvas.write_png(pngPath);
 }
 void refresh_main_canvas(ezgl::renderer &g) {
     
@@ -65,29 +112,58 @@ void refresh_main_canvas(ezgl::renderer &g) {
         store.newMapLoadFlag = false;
     }
     
+    // Each layer is timed only if profiling is enabled, see RenderProfiler
+    bool profiling = store.profilingFlag;
+    if (profiling) store.renderProfiler.startFrame(store.zoomLevel);
+    
     // Sets map backdrop
     g.set_color(ezgl::LIGHT_GRAY);
     g.fill_rectangle(g.get_visible_world());
     
+    if (profiling) store.renderProfiler.startLayer(FEATURES_LAYER);
     drawFeatures(g);
+    if (profiling) store.renderProfiler.endLayer(FEATURES_LAYER);
+    
+    if (profiling) store.renderProfiler.startLayer(STREETS_LAYER);
     drawStreets(g);
+    if (profiling) store.renderProfiler.endLayer(STREETS_LAYER);
+    
+    // Drawn only once an isochrone is computed, over the streets so the stops and highlights stay visible
+    if (store.drawIsochrone) {
+        if (profiling) store.renderProfiler.startLayer(ISOCHRONE_LAYER);
+        drawIsochrone(g);
+        if (profiling) store.renderProfiler.endLayer(ISOCHRONE_LAYER);
+    }
     
     // Called every refresh but if no focused route (store.FOCUSED_ROUTE == -1), then will never draw any stops
+    if (profiling) store.renderProfiler.startLayer(BUS_STOPS_LAYER);
     drawBusStops(g);
+    if (profiling) store.renderProfiler.endLayer(BUS_STOPS_LAYER);
     
     // To be called when close enough to see details
     if (store.zoomLevel >= 8) { 
+        if (profiling) store.renderProfiler.startLayer(POI_LAYER);
         drawPointsOfInterest(g);
+        if (profiling) store.renderProfiler.endLayer(POI_LAYER);
     }
     
     // Drawn on top of all, as they are highlights to indicate the users
+    if (profiling) store.renderProfiler.startLayer(HIGHLIGHTS_LAYER);
     drawHighlighedIntersections(g);
     drawHighlightedPointsOfInterests(g);
     drawUserLoc(g);
+    if (profiling) store.renderProfiler.endLayer(HIGHLIGHTS_LAYER);
     
     // Drawn only once a path is selected
     if(store.drawPath){
+        if (profiling) store.renderProfiler.startLayer(PATH_LAYER);
         drawPath(g);
+        if (profiling) store.renderProfiler.endLayer(PATH_LAYER);
+    }
+    
+    if (profiling) {
+        store.renderProfiler.endFrame();
+        if (mainApplication != nullptr) mainApplication->update_status(store.renderProfiler.getSummary());
     }
 }
 
@@ -97,6 +173,7 @@ void initial_setup(ezgl::application *application)
   auto canvas = application->get_canvas(main_canvas_id);
   
   std::string status_message = "Successfully loaded map";
+  mainApplication = application;
           
   // Initial zoom to prettify map
   ezgl::zoom_in(canvas, 5.0 / 3.0);
@@ -115,6 +192,11 @@ void initial_setup(ezgl::application *application)
   // Init auto complete
   application->initializeAutoComplete();
   
+  // Redraw with the user marker once the background location lookup finishes
+  if (store.locationService.getState() == LOCATION_PENDING) {
+    userLocationSource = g_timeout_add(LOCATION_POLL_INTERVAL, checkUserLocation, application);
+  }
+  
   // Update status of map load
   application->update_status(status_message);  
 }
@@ -135,7 +217,7 @@ void act_on_mouse_press(ezgl::application *application, GdkEventButton *event, d
         std::cout << getIntersectionName(intersectionID) << std::endl;
          
         if (store.clicked.size() == 2) {
-            store.path = find_path_between_intersections(store.clicked[0], store.clicked[1], store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+            store.path = findCachedPath(store.clicked[0], store.clicked[1], store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
             store.drawPath = true;
             
             store.clicked.clear();
@@ -4,6 +4,7 @@
 #include "m1.h"
 #include "m3.h"
 #include "WaveElement.h"
+#include "SearchStats.h"
 #include "util.h"
 #include "Store.h"
 
@@ -115,14 +116,20 @@ bool searchPath (const unsigned intersection_id_start, const unsigned intersecti
     
     double aStarCost;
     
+    // Work counted for the benchmark, added to the totals when the search ends
+    SearchStats stats;
+    stats.searches = 1;
+    
     // Add the source as the first element
     IntersectionSearchNode* source = store.intersectionSearchNodes[intersection_id_start];
     wavefront.push(WaveElement(source, NO_EDGE, 0, 0));
+    stats.heapPushes++;
     
     while (!wavefront.empty()) {
         // Pop off the top of the queue, most promising node
         WaveElement wave = wavefront.top();
         wavefront.pop();
+        stats.heapPops++;
         
         // Get its corresponding searchNode
         IntersectionSearchNode* currentNode = wave.getSearchNode();
@@ -131,9 +138,13 @@ bool searchPath (const unsigned intersection_id_start, const unsigned intersecti
             currentNode->setReachingSegment(wave.getSegmentID());
             // If time to get there is the faster than update it
             currentNode->setBestTime(wave.getTravelTime());
+            stats.settledNodes++;
             
             // Found destination
-            if (currentNode->getID() == intersection_id_end) return true;
+            if (currentNode->getID() == intersection_id_end) {
+                recordSearch(stats);
+                return true;
+            }
             
             // Get the parent's outgoingSegments and children intersections
             const std::vector<unsigned>& outgoingSegments = currentNode->getSegments();
@@ -166,11 +177,13 @@ bool searchPath (const unsigned intersection_id_start, const unsigned intersecti
                         aStarCost = heuristic(searchNode->getID(), intersection_id_end);
 
                         wavefront.push(WaveElement(searchNode, *edge, nodeToNodeCost, nodeToNodeCost + aStarCost));
+                        stats.heapPushes++;
                     }
                 }
             }
         } 
     }
+    recordSearch(stats);
     return false;
 }
 
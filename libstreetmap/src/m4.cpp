@@ -30,6 +30,9 @@ std::vector<CourierSubpath> traveling_courier(
         const float left_turn_penalty,
         const float truck_capacity) {
     
+    CourierTrace& trace = store.courierTrace;
+    trace.start();
+    
     pathMap.clear();
     pathTimes.clear();
 
@@ -59,11 +62,15 @@ std::vector<CourierSubpath> traveling_courier(
     for (unsigned i = 0; i < intersectionsVector.size(); i++) {
         pathMap.insert(std::make_pair(intersectionsVector[i], i));
     }
+    trace.endMatrix();
 
     std::vector<CourierSubpath> idealPath;
     double smallestTravelTime = DBL_MAX;
 
-    if (deliveries.empty() || depots.empty()) return idealPath;
+    if (deliveries.empty() || depots.empty()) {
+        trace.finish();
+        return idealPath;
+    }
 
     std::pair<std::vector<CourierSubpath>, double> depotPath;
 
@@ -72,9 +79,11 @@ std::vector<CourierSubpath> traveling_courier(
         if (depotPath.second < smallestTravelTime) {
             smallestTravelTime = depotPath.second;
             idealPath = depotPath.first;
+            trace.improve(smallestTravelTime);
         }
     }
 
+    trace.finish();
     return idealPath;
 }
 
@@ -1,4 +1,5 @@
 #include "util.h"
+#include "SearchStats.h"
 
 double lonToX(double lon) {
     return lon*cos(store.LAT_AVG) * DEG_TO_RAD;
@@ -118,48 +119,68 @@ int getStreetDrawLevel(std::string streetType) {
     return 1;
 }
 
-size_t curl_write(void *ptr, size_t size, size_t nmemb, void *stream) {
-    (void) stream;
-    
-    store.responseBuffer.append((char*)ptr, size * nmemb);
+// libcurl write callback into the std::string passed as CURLOPT_WRITEDATA
+static size_t curl_write_string(void *ptr, size_t size, size_t nmemb, void *stream) {
+    static_cast<std::string*>(stream)->append((char*)ptr, size * nmemb);
     return size * nmemb;
 }
 
-std::vector<unsigned> find_intersection_ids_from_partial_intersection_name(std::string intersection_prefix){
-    std::vector<unsigned> inter_ids;
+// libcurl progress callback, aborts the transfer once the flag passed as CURLOPT_XFERINFODATA is set
+static int curl_cancel(void *cancelled, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    return cancelled != nullptr && static_cast<const std::atomic<bool>*>(cancelled)->load() ? 1 : 0;
+}
 
-    if (intersection_prefix.length() == 0) return inter_ids;
-    
-    // Sanitize input to be lowercase
-    std::transform(intersection_prefix.begin(), intersection_prefix.end(), intersection_prefix.begin(), ::tolower);
-  
-    // Split the string using spaces as delimiters
-    std::vector<std::string> strs;
-    boost::split(strs, intersection_prefix, boost::is_any_of(" "));
-    
-    // Prepares string to be used as the regular expression
-    std::string reg_prefix;
-    for(auto it = strs.begin(); it !=  strs.end(); it++){
-        if(it == strs.begin()) reg_prefix += ".*(" + *it + ").*";
-        else reg_prefix += "(" + *it + ").*";
-    }
+// Request headers of the XML APIs
+std::vector<std::string> getXMLRequestHeaders() {
+    return {"Accept: application/xml", "charset: utf-8"};
+}
+
+/* Fetches url into response, safe to call from any thread
+ * @params url, timeoutMs for the whole transfer, response, optional flag that aborts the transfer once set
+ * @returns whether the transfer completed with a 2xx status
+ */
+bool fetchURL(std::string url, long timeoutMs, std::string& response, const std::atomic<bool>* cancelled) {
+    CURL *curlHandle = curl_easy_init();
+    if (curlHandle == nullptr) return false;
+    response = "";
     
-    std::regex base_regex(reg_prefix);
+    curl_easy_setopt(curlHandle, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, curl_write_string);
+    curl_easy_setopt(curlHandle, CURLOPT_WRITEDATA, &response);
+    curl_easy_setopt(curlHandle, CURLOPT_TIMEOUT_MS, timeoutMs);
+    curl_easy_setopt(curlHandle, CURLOPT_CONNECTTIMEOUT_MS, timeoutMs);
     
-    // Finds the closest matches and appends the ids
-    for (auto it = store.INTERSECTION_DICTIONARY.lower_bound(intersection_prefix); it != store.INTERSECTION_DICTIONARY.end(); it++) {
-        if(std::regex_match(it->first, base_regex)) inter_ids.insert(inter_ids.end(), it->second.begin(), it->second.end());
-    }
+    // Signals are not thread safe, and the progress callback lets the caller cancel
+    curl_easy_setopt(curlHandle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curlHandle, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curlHandle, CURLOPT_XFERINFOFUNCTION, curl_cancel);
+    curl_easy_setopt(curlHandle, CURLOPT_XFERINFODATA, const_cast<std::atomic<bool>*>(cancelled));
     
-    return inter_ids;
+    long status = 0;
+    bool success = curl_easy_perform(curlHandle) == CURLE_OK;
+    curl_easy_getinfo(curlHandle, CURLINFO_RESPONSE_CODE, &status);
+    
+    curl_easy_cleanup(curlHandle);
+    
+    return success && status >= 200 && status < 300;
+}
+
+/* Finds the intersections whose name contains every word of intersection_prefix, in any order
+ * The last word may be partially typed, and punctuation such as '&' is ignored
+ * @params intersection_prefix, the user's search
+ * @returns sorted intersection ids
+ */
+std::vector<unsigned> find_intersection_ids_from_partial_intersection_name(std::string intersection_prefix){
+    return store.INTERSECTION_TOKEN_INDEX.find(intersection_prefix);
 }
 
 std::pair<LatLon, int> findClosestBusStop(LatLon position) {
     std::pair<LatLon, int> stop;
     if (store.routes.find(store.focusedRoute) == store.routes.end()) return std::make_pair(LatLon(0, 0), -1);
     
-    //get bus stop points to search through
+    //get bus stop points to search through, which are empty until the route's stops arrive
     const std::vector<std::pair<LatLon, int>>& points = store.routes.find(store.focusedRoute)->second->getStopPoints();
+    if (points.empty()) return std::make_pair(LatLon(0, 0), -1);
     int currentDistance, shortestDistance;
     
     shortestDistance = find_distance_between_two_points(position, points[0].first);
@@ -188,40 +209,6 @@ double heuristic(const unsigned node, const unsigned goalNode) {
     return distance / (store.topSpeedLimit / KM_H_TO_M_S);
 }
 
-// Returns the LatLon of the location of the user by calling an API
-LatLon getUserLatLon(){
-    using namespace boost::property_tree;
-    ptree propertyTree;
-    
-    float lat = 0, lon = 0;
-    
-    CURL *curlHandle = curl_easy_init();
-    store.responseBuffer = "";
-    
-    std::string url = "https://api.ipdata.co/?api-key=570c726f0272bf61a8acce72ff76e37eb4e871045bdfa305c1bed191";
-    
-    curl_easy_setopt(curlHandle, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, curl_write);  
-    
-    // Get response
-    curl_easy_perform(curlHandle);
-
-    // Parse into property trees
-    std::istringstream inputStream(store.responseBuffer);
-    read_json(inputStream, propertyTree);
-    
-    for(auto i=propertyTree.begin(); i!=propertyTree.end(); i++){
-        if(i->first == "latitude") lat = i->second.get_value<float>();
-        if(i->first == "longitude") lon = i->second.get_value<float>();
-    }
-    
-    LatLon position(lat, lon);
-    
-    curl_easy_cleanup(curlHandle);
-    
-    return position;
-}
-
 // Wrapper function for finding path b/w intersections
 std::unordered_map<unsigned, std::pair<double, std::vector<unsigned>>> find_paths_to_destinations (const unsigned intersect_id_start, 
         const std::unordered_set<unsigned>& destinations, 
@@ -285,15 +272,21 @@ bool searchMultiPath (const unsigned intersection_id_start, const std::unordered
     // Wavefront queue, sorted by the aStar heuristic
     std::priority_queue<WaveElement, std::vector<WaveElement>, std::greater<WaveElement>> wavefront;
     
+    // Work counted for the benchmark, added to the totals when the search ends
+    SearchStats stats;
+    stats.searches = 1;
+    
     // Add the source as the first element
     IntersectionSearchNode* source = searchNodes[intersection_id_start];
     wavefront.push(WaveElement(source, NO_EDGE, 0, 0));
+    stats.heapPushes++;
     
     unsigned destinationsReached = 0;
     while (!wavefront.empty() && destinationsReached != destinations.size()) {
         // Pop off the top of the queue, most promising node
         WaveElement wave = wavefront.top();
         wavefront.pop();
+        stats.heapPops++;
         
         // Get its corresponding searchNode
         IntersectionSearchNode* currentNode = wave.getSearchNode();
@@ -302,6 +295,7 @@ bool searchMultiPath (const unsigned intersection_id_start, const std::unordered
             currentNode->setReachingSegment(wave.getSegmentID());
             // If time to get there is the faster than update it
             currentNode->setBestTime(wave.getTravelTime());
+            stats.settledNodes++;
             
             // Found a destination
             if (destinations.find(currentNode->getID()) != destinations.end()) destinationsReached++;
@@ -334,13 +328,47 @@ bool searchMultiPath (const unsigned intersection_id_start, const std::unordered
                         double nodeToNodeCost = currentNode->getBestTime() + store.SEGMENTS[*edge]->getTravelTime() + turn_penalty;
 
                         wavefront.push(WaveElement(searchNode, *edge, nodeToNodeCost, nodeToNodeCost));
+                        stats.heapPushes++;
                     }
                 }
             }
         } 
     }
+    recordSearch(stats);
     
     if (destinations.size() > 0) return true;
     
     return false;
-}
\ No newline at end of file
+}
+
+/* Display names for autocomplete, ranked by the name index, shortest first
+ * @params prefix typed so far
+ * @returns at most COMPLETION_MAX_RESULTS names, empty if the prefix is too short
+ */
+std::vector<std::string> getCompletions(std::string prefix) {
+    std::vector<std::string> completions;
+    if (prefix.length() < COMPLETION_MIN_PREFIX_LENGTH) return completions;
+    
+    std::vector<NameEntry> entries = store.NAME_INDEX.complete(prefix, COMPLETION_MAX_RESULTS);
+    for (auto entry = entries.begin(); entry != entries.end(); entry++) {
+        switch (entry->type) {
+            case STREET_ENTITY: completions.push_back(getStreetName(entry->id)); break;
+            case POI_ENTITY: completions.push_back(getPointOfInterestName(entry->id)); break;
+            case INTERSECTION_ENTITY: completions.push_back(getIntersectionName(entry->id)); break;
+            default: break;
+        }
+    }
+    
+    return completions;
+}
+
+// Path of the streets database of a map name, such as toronto_canada
+std::string getMapPath(std::string mapName) {
+    return MAP_DIRECTORY + mapName + ".streets.bin";
+}
+
+// Checked before a map change, so a search that is not a map name never closes the current map
+bool mapExists(std::string mapName) {
+    std::ifstream mapFile(getMapPath(mapName));
+    return mapFile.good();
+}
@@ -10,13 +10,14 @@
 #include "LatLon.h"
 #include "WaveElement.h"
 
-#include <regex>
 #include <curl/curl.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/foreach.hpp>
+#include <atomic>
 #include <queue>
+#include <fstream>
 #include <unordered_set>
 
 #include <ezgl/application.hpp>
@@ -28,6 +29,27 @@
 
 #define KM_H_TO_M_S 3.6
 #define DEFAULT_ZOOM_SCALE 5.0/3.0
+#define MAX_ZOOM_LEVEL 11
+
+#define MAP_DIRECTORY "/cad2/ece297s/public/maps/"
+
+// Fuzzy search limits, queries shorter than FUZZY_LONG_QUERY_LENGTH allow a single edit
+#define FUZZY_MIN_QUERY_LENGTH 3
+#define FUZZY_LONG_QUERY_LENGTH 6
+#define FUZZY_MAX_RESULTS 5
+
+// Autocomplete limits, completions are only looked up once the prefix is long enough
+#define COMPLETION_MIN_PREFIX_LENGTH 2
+#define COMPLETION_MAX_RESULTS 10
+
+// Widest screen the feature visibility thresholds are computed for, in pixels
+#define REFERENCE_SCREEN_WIDTH 1920
+
+// How long API responses are reused, in seconds
+#define BUS_ROUTES_TTL 86400
+#define BUS_STOPS_TTL 86400
+#define BUS_PREDICTIONS_TTL 15
+#define WEATHER_TTL 600
 
 // Coordinate conversion functions
 double lonToX(double lon);
@@ -41,8 +63,9 @@ float getStreetWidth(std::string streetType);
 int getStreetDrawLevel(std::string streetType);
 float streetZoomScale(float slope);
 
-// libcurl write buffer write callback
-size_t curl_write(void *ptr, size_t size, size_t nmemb, void *stream);
+// Blocking fetch with a timeout, for use off the GUI thread, GUI requests go through store.httpClient
+bool fetchURL(std::string url, long timeoutMs, std::string& response, const std::atomic<bool>* cancelled = nullptr);
+std::vector<std::string> getXMLRequestHeaders();
 
 // Misc. functions
 LatLon averageLatLon(LatLon from, LatLon to);
@@ -50,8 +73,12 @@ double segmentRotationAngle(LatLon from, LatLon to);
 std::pair<LatLon, int> findClosestBusStop(LatLon position);
 std::string stringSplit(std::string text, std::string delimOne, std::string delimTwo);
 
-// Location functions
-LatLon getUserLatLon();
+// Display names of the top ranked streets, intersections and POIs starting with prefix
+std::vector<std::string> getCompletions(std::string prefix);
+
+// Map file functions
+std::string getMapPath(std::string mapName);
+bool mapExists(std::string mapName);
 
 bool searchPath (const unsigned intersection_id_start, const unsigned intersection_id_end, const double right_turn_penalty, const double left_turn_penalty) ;
 std::vector<unsigned> traceBack(const unsigned destID);
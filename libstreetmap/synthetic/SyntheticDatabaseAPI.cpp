@@ -0,0 +1,136 @@
+/* In-memory stand-in for the streets and OSM database libraries, serving a generated SyntheticMap
+ * Linked instead of libstreetsdatabase, so load_map and everything above it run unchanged on synthetic maps
+ * Map names are parsed by parseSyntheticMapName, e.g. load_map("synthetic_grid_1M_highways.streets.bin")
+ * No OSM ways are generated, so segments keep their default draw style
+ */
+
+#include "SyntheticMap.h"
+#include "StreetsDatabaseAPI.h"
+#include "OSMDatabaseAPI.h"
+
+// Map served by the API functions, empty when no map is loaded
+static SyntheticMap loadedMap;
+static bool streetsLoaded = false;
+
+bool loadStreetsDatabaseBIN(std::string path) {
+    SyntheticMapOptions options;
+    if (!parseSyntheticMapName(path, options)) return false;
+
+    loadedMap = generateSyntheticMap(options);
+    streetsLoaded = true;
+    return true;
+}
+
+void closeStreetDatabase() {
+    loadedMap = SyntheticMap();
+    streetsLoaded = false;
+}
+
+// The OSM database of a synthetic map is only valid next to its streets database
+bool loadOSMDatabaseBIN(const std::string& path) {
+    SyntheticMapOptions options;
+    return streetsLoaded && parseSyntheticMapName(path, options);
+}
+
+void closeOSMDatabase() {
+}
+
+int getNumStreets() {
+    return loadedMap.streetNames.size();
+}
+
+int getNumStreetSegments() {
+    return loadedMap.segments.size();
+}
+
+int getNumIntersections() {
+    return loadedMap.intersectionPositions.size();
+}
+
+int getNumPointsOfInterest() {
+    return loadedMap.pois.size();
+}
+
+int getNumFeatures() {
+    return loadedMap.features.size();
+}
+
+std::string getIntersectionName(IntersectionIndex intersectionIdx) {
+    return getSyntheticIntersectionName(loadedMap, intersectionIdx);
+}
+
+LatLon getIntersectionPosition(IntersectionIndex intersectionIdx) {
+    return loadedMap.intersectionPositions[intersectionIdx];
+}
+
+OSMID getIntersectionOSMNodeID(IntersectionIndex intersectionIdx) {
+    return OSMID(intersectionIdx + 1);
+}
+
+int getIntersectionStreetSegmentCount(IntersectionIndex intersectionIdx) {
+    return loadedMap.segmentOffsets[intersectionIdx + 1] - loadedMap.segmentOffsets[intersectionIdx];
+}
+
+StreetSegmentIndex getIntersectionStreetSegment(int segmentNum, IntersectionIndex intersectionIdx) {
+    return loadedMap.intersectionSegments[loadedMap.segmentOffsets[intersectionIdx] + segmentNum];
+}
+
+LatLon getStreetSegmentCurvePoint(int curvePointNum, StreetSegmentIndex streetSegmentIdx) {
+    return loadedMap.curvePoints[loadedMap.curvePointOffsets[streetSegmentIdx] + curvePointNum];
+}
+
+InfoStreetSegment getInfoStreetSegment(StreetSegmentIndex streetSegmentIdx) {
+    return loadedMap.segments[streetSegmentIdx];
+}
+
+std::string getStreetName(StreetIndex streetIdx) {
+    return loadedMap.streetNames[streetIdx];
+}
+
+std::string getPointOfInterestType(POIIndex poiIdx) {
+    return loadedMap.pois[poiIdx].type;
+}
+
+std::string getPointOfInterestName(POIIndex poiIdx) {
+    return loadedMap.pois[poiIdx].name;
+}
+
+LatLon getPointOfInterestPosition(POIIndex poiIdx) {
+    return loadedMap.pois[poiIdx].position;
+}
+
+std::string getFeatureName(FeatureIndex featureIdx) {
+    return loadedMap.features[featureIdx].name;
+}
+
+FeatureType getFeatureType(FeatureIndex featureIdx) {
+    return loadedMap.features[featureIdx].type;
+}
+
+int getFeaturePointCount(FeatureIndex featureIdx) {
+    return loadedMap.features[featureIdx].points.size();
+}
+
+LatLon getFeaturePoint(int pointNum, FeatureIndex featureIdx) {
+    return loadedMap.features[featureIdx].points[pointNum];
+}
+
+// Synthetic maps have no OSM ways, so the entity functions below are never reached
+unsigned getNumberOfWays() {
+    return 0;
+}
+
+const OSMWay* getWayByIndex(unsigned idx) {
+    (void) idx;
+    return nullptr;
+}
+
+unsigned getTagCount(const OSMEntity* entity) {
+    (void) entity;
+    return 0;
+}
+
+std::pair<std::string, std::string> getTagPair(const OSMEntity* entity, unsigned idx) {
+    (void) entity; (void) idx;
+    return std::make_pair(std::string(), std::string());
+}
@@ -0,0 +1,327 @@
+#include "SyntheticMap.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+// Meters per degree of latitude, on the sphere used by find_distance_between_two_points
+#define METERS_PER_DEGREE (6372797.560856 * M_PI / 180)
+
+static const char* const NAME_SYLLABLES[] = {
+    "ash", "bel", "cor", "dun", "el", "fair", "glen", "har", "kings", "lin", "mont", "north", "oak", "pem", "ros", "wood"
+};
+static const char* const STREET_SUFFIXES[] = {"Street", "Avenue", "Road", "Crescent", "Boulevard", "Drive"};
+static const char* const POI_TYPES[] = {"restaurant", "cafe", "school", "bank", "fuel", "parking", "hospital", "pharmacy"};
+
+template <typename T, std::size_t N>
+static std::size_t arraySize(const T (&)[N]) {
+    return N;
+}
+
+// Capitalized name of 2 or 3 random syllables, e.g. "Glenoak"
+static std::string makeName(std::mt19937& random) {
+    std::uniform_int_distribution<std::size_t> syllable(0, arraySize(NAME_SYLLABLES) - 1);
+    unsigned syllableCount = 2 + random() % 2;
+
+    std::string name;
+    for (unsigned i = 0; i < syllableCount; i++) name += NAME_SYLLABLES[syllable(random)];
+    name[0] = std::toupper(name[0]);
+
+    return name;
+}
+
+static std::string makeStreetName(std::mt19937& random, bool highway, unsigned highwayNumber) {
+    if (highway) return "Highway " + std::to_string(highwayNumber);
+    return makeName(random) + " " + STREET_SUFFIXES[random() % arraySize(STREET_SUFFIXES)];
+}
+
+// Position offset from origin by meters north and east
+static LatLon offsetPosition(LatLon origin, double north, double east) {
+    double lat = origin.lat() + north / METERS_PER_DEGREE;
+    double lon = origin.lon() + east / (METERS_PER_DEGREE * std::cos(origin.lat() * M_PI / 180));
+    return LatLon(lat, lon);
+}
+
+/* Collects segments in generation order, then builds the per intersection segment lists
+ * Segments of an intersection are listed in the order they were added
+ */
+class SegmentBuilder {
+public:
+    SegmentBuilder(SyntheticMap& generated) : map(generated) {
+        map.curvePointOffsets.push_back(0);
+    }
+
+    void addSegment(int from, int to, int street, bool oneWay, bool highway, std::vector<LatLon> curve = std::vector<LatLon>()) {
+        InfoStreetSegment info;
+        info.wayOSMID = OSMID(street + 1);
+        info.from = from;
+        info.to = to;
+        info.oneWay = oneWay;
+        info.curvePointCount = curve.size();
+        info.speedLimit = highway ? SYNTHETIC_HIGHWAY_SPEED : SYNTHETIC_LOCAL_SPEED;
+        info.streetID = street;
+
+        map.segments.push_back(info);
+        map.curvePoints.insert(map.curvePoints.end(), curve.begin(), curve.end());
+        map.curvePointOffsets.push_back(map.curvePoints.size());
+    }
+
+    void build() {
+        unsigned intersectionCount = map.intersectionPositions.size();
+
+        map.segmentOffsets.assign(intersectionCount + 1, 0);
+        for (auto segment = map.segments.begin(); segment != map.segments.end(); segment++) {
+            map.segmentOffsets[segment->from + 1]++;
+            map.segmentOffsets[segment->to + 1]++;
+        }
+        for (unsigned i = 0; i < intersectionCount; i++) map.segmentOffsets[i + 1] += map.segmentOffsets[i];
+
+        std::vector<unsigned> next(map.segmentOffsets.begin(), map.segmentOffsets.end() - 1);
+        map.intersectionSegments.resize(map.segmentOffsets.back());
+        for (unsigned id = 0; id < map.segments.size(); id++) {
+            map.intersectionSegments[next[map.segments[id].from]++] = id;
+            map.intersectionSegments[next[map.segments[id].to]++] = id;
+        }
+    }
+
+private:
+    SyntheticMap& map;
+};
+
+/* Grid of rows and columns, the last row is partial so the count is exact
+ * Rows are one way in alternating directions when picked, columns are always two way
+ */
+static void generateGrid(const SyntheticMapOptions& options, SyntheticMap& map, std::mt19937& random) {
+    unsigned count = std::max(1u, options.intersectionCount);
+    unsigned columns = std::ceil(std::sqrt((double)count));
+    unsigned rows = (count + columns - 1) / columns;
+
+    // Positions jittered by up to a tenth of a block, so no two distances tie exactly
+    std::uniform_real_distribution<double> jitter(-SYNTHETIC_BLOCK_LENGTH / 10.0, SYNTHETIC_BLOCK_LENGTH / 10.0);
+    for (unsigned id = 0; id < count; id++) {
+        unsigned row = id / columns, column = id % columns;
+        map.intersectionPositions.push_back(offsetPosition(options.origin,
+                row * SYNTHETIC_BLOCK_LENGTH + jitter(random), column * SYNTHETIC_BLOCK_LENGTH + jitter(random)));
+        map.intersectionStreets.push_back(std::make_pair(row, rows + column));
+    }
+
+    // Streets [0, rows) are rows, [rows, rows + columns) are columns
+    std::uniform_real_distribution<double> chance(0, 1);
+    std::vector<bool> highwayStreets, oneWayStreets;
+    for (unsigned street = 0; street < rows + columns; street++) {
+        unsigned index = street < rows ? street : street - rows;
+        bool highway = options.highways && index % SYNTHETIC_HIGHWAY_SPACING == 0;
+
+        highwayStreets.push_back(highway);
+        oneWayStreets.push_back(street < rows && !highway && chance(random) < options.oneWayFraction);
+        map.streetNames.push_back(makeStreetName(random, highway, street));
+    }
+
+    SegmentBuilder builder(map);
+    for (unsigned id = 0; id < count; id++) {
+        unsigned row = id / columns, column = id % columns;
+
+        // Highway segments bend through their midpoint, so curve points are exercised
+        if (column + 1 < columns && id + 1 < count) {
+            std::vector<LatLon> curve;
+            if (highwayStreets[row]) {
+                LatLon from = map.intersectionPositions[id], to = map.intersectionPositions[id + 1];
+                curve.push_back(LatLon((from.lat() + to.lat()) / 2, (from.lon() + to.lon()) / 2));
+            }
+
+            bool reversed = oneWayStreets[row] && row % 2 == 1;
+            builder.addSegment(reversed ? id + 1 : id, reversed ? id : id + 1, row, oneWayStreets[row], highwayStreets[row], curve);
+        }
+
+        if (id + columns < count) {
+            builder.addSegment(id, id + columns, rows + column, false, highwayStreets[rows + column]);
+        }
+    }
+    builder.build();
+}
+
+/* Rings around a center joined by spokes, with as many full rings as fit the count
+ * Rings are one way in alternating directions when picked, spokes are always two way
+ */
+static void generateRadial(const SyntheticMapOptions& options, SyntheticMap& map, std::mt19937& random) {
+    unsigned count = std::max(4u, options.intersectionCount);
+
+    // About 2 pi spokes per ring, so the outer ring's blocks are about as long as the spokes'
+    unsigned rings = std::max(1.0, std::round(std::sqrt((count - 1) / (2 * M_PI))));
+    unsigned spokes = std::max(3u, (count - 2) / rings + 1);
+    unsigned highwaySpokes = std::max(1u, spokes / 4);
+
+    // Streets [0, spokes) are spokes, [spokes, spokes + rings) are rings
+    std::uniform_real_distribution<double> chance(0, 1);
+    std::vector<bool> highwayStreets, oneWayStreets;
+    for (unsigned street = 0; street < spokes + rings; street++) {
+        bool spoke = street < spokes;
+        unsigned ring = street - spokes + 1;
+        bool highway = options.highways && (spoke ? street % highwaySpokes == 0 : ring % SYNTHETIC_HIGHWAY_SPACING == 0);
+
+        highwayStreets.push_back(highway);
+        oneWayStreets.push_back(!spoke && !highway && chance(random) < options.oneWayFraction);
+        map.streetNames.push_back(makeStreetName(random, highway, street));
+    }
+
+    auto node = [spokes](unsigned ring, unsigned spoke) { return 1 + (ring - 1) * spokes + spoke; };
+    auto position = [&options, spokes](double ring, double spoke) {
+        double angle = 2 * M_PI * spoke / spokes;
+        return offsetPosition(options.origin, ring * SYNTHETIC_BLOCK_LENGTH * std::sin(angle), ring * SYNTHETIC_BLOCK_LENGTH * std::cos(angle));
+    };
+
+    map.intersectionPositions.push_back(options.origin);
+    map.intersectionStreets.push_back(std::make_pair(0, spokes / 2));
+    for (unsigned ring = 1; ring <= rings; ring++) {
+        for (unsigned spoke = 0; spoke < spokes; spoke++) {
+            map.intersectionPositions.push_back(position(ring, spoke));
+            map.intersectionStreets.push_back(std::make_pair(spoke, spokes + ring - 1));
+        }
+    }
+
+    SegmentBuilder builder(map);
+    for (unsigned spoke = 0; spoke < spokes; spoke++) {
+        builder.addSegment(0, node(1, spoke), spoke, false, highwayStreets[spoke]);
+        for (unsigned ring = 1; ring < rings; ring++) {
+            builder.addSegment(node(ring, spoke), node(ring + 1, spoke), spoke, false, highwayStreets[spoke]);
+        }
+    }
+
+    // Ring segments follow the arc through its midpoint
+    for (unsigned ring = 1; ring <= rings; ring++) {
+        unsigned street = spokes + ring - 1;
+        bool reversed = oneWayStreets[street] && ring % 2 == 0;
+
+        for (unsigned spoke = 0; spoke < spokes; spoke++) {
+            unsigned from = node(ring, spoke), to = node(ring, (spoke + 1) % spokes);
+            std::vector<LatLon> curve(1, position(ring, spoke + 0.5));
+            if (reversed) {
+                std::swap(from, to);
+                std::reverse(curve.begin(), curve.end());
+            }
+            builder.addSegment(from, to, street, oneWayStreets[street], highwayStreets[street], curve);
+        }
+    }
+    builder.build();
+}
+
+// POIs a short walk from random intersections
+static void generatePOIs(SyntheticMap& map, std::mt19937& random) {
+    unsigned count = std::max<unsigned>(1, map.intersectionPositions.size() / SYNTHETIC_POI_RATIO);
+    std::uniform_int_distribution<std::size_t> intersection(0, map.intersectionPositions.size() - 1);
+    std::uniform_real_distribution<double> offset(-SYNTHETIC_BLOCK_LENGTH / 3.0, SYNTHETIC_BLOCK_LENGTH / 3.0);
+
+    for (unsigned i = 0; i < count; i++) {
+        SyntheticPOI poi;
+        poi.type = POI_TYPES[random() % arraySize(POI_TYPES)];
+        poi.position = offsetPosition(map.intersectionPositions[intersection(random)], offset(random), offset(random));
+
+        std::string type = poi.type;
+        type[0] = std::toupper(type[0]);
+        poi.name = makeName(random) + " " + type;
+
+        map.pois.push_back(poi);
+    }
+}
+
+// Closed polygons for areas, open polylines for rivers and streams
+static void generateFeatures(SyntheticMap& map, std::mt19937& random) {
+    static const FeatureType types[] = {Building, Building, Building, Park, Greenspace, Lake, River, Stream, Beach, Golfcourse, Island};
+
+    unsigned count = std::max<unsigned>(1, map.intersectionPositions.size() / SYNTHETIC_FEATURE_RATIO);
+    std::uniform_int_distribution<std::size_t> intersection(0, map.intersectionPositions.size() - 1);
+    std::uniform_real_distribution<double> unit(0, 1);
+
+    for (unsigned i = 0; i < count; i++) {
+        SyntheticFeature feature;
+        feature.type = types[random() % arraySize(types)];
+        LatLon center = offsetPosition(map.intersectionPositions[intersection(random)],
+                SYNTHETIC_BLOCK_LENGTH / 2.0, SYNTHETIC_BLOCK_LENGTH / 2.0);
+
+        if (feature.type == River || feature.type == Stream) {
+            // Random walk across a few blocks
+            double north = 0, east = 0, heading = unit(random) * 2 * M_PI;
+            unsigned points = 5 + random() % 6;
+            for (unsigned point = 0; point < points; point++) {
+                feature.points.push_back(offsetPosition(center, north, east));
+                heading += (unit(random) - 0.5) * M_PI / 2;
+                north += SYNTHETIC_BLOCK_LENGTH * std::sin(heading);
+                east += SYNTHETIC_BLOCK_LENGTH * std::cos(heading);
+            }
+            feature.name = makeName(random) + (feature.type == River ? " River" : " Creek");
+        } else {
+            // Buildings fit inside a block, other areas span a few blocks
+            double radius = SYNTHETIC_BLOCK_LENGTH * (feature.type == Building ? 0.1 + 0.2 * unit(random) : 0.5 + 2 * unit(random));
+            unsigned points = 4 + random() % 5;
+            for (unsigned point = 0; point < points; point++) {
+                double angle = 2 * M_PI * point / points;
+                feature.points.push_back(offsetPosition(center, radius * std::sin(angle), radius * std::cos(angle)));
+            }
+            feature.points.push_back(feature.points.front());
+            if (feature.type != Building) feature.name = makeName(random) + " Park";
+        }
+
+        map.features.push_back(feature);
+    }
+}
+
+SyntheticMap generateSyntheticMap(const SyntheticMapOptions& options) {
+    SyntheticMap map;
+    std::mt19937 random(options.seed);
+
+    if (options.layout == RADIAL_LAYOUT) generateRadial(options, map, random);
+    else generateGrid(options, map, random);
+
+    generatePOIs(map, random);
+    generateFeatures(map, random);
+
+    return map;
+}
+
+bool parseSyntheticMapName(std::string name, SyntheticMapOptions& options) {
+    std::size_t slash = name.rfind('/');
+    if (slash != std::string::npos) name = name.substr(slash + 1);
+    name = name.substr(0, name.find('.'));
+
+    std::vector<std::string> tokens;
+    std::istringstream input(name);
+    for (std::string token; std::getline(input, token, '_'); ) tokens.push_back(token);
+
+    if (tokens.size() < 3 || tokens[0] != "synthetic") return false;
+
+    SyntheticMapOptions parsed;
+    if (tokens[1] == "grid") parsed.layout = GRID_LAYOUT;
+    else if (tokens[1] == "radial") parsed.layout = RADIAL_LAYOUT;
+    else return false;
+
+    // Counts may be given in thousands or millions, e.g. 100k or 5M
+    try {
+        std::size_t end = 0;
+        double count = std::stod(tokens[2], &end);
+        std::string unit = tokens[2].substr(end);
+        if (unit == "k" || unit == "K") count *= 1000;
+        else if (unit == "m" || unit == "M") count *= 1000000;
+        else if (!unit.empty()) return false;
+        if (count < 1) return false;
+        parsed.intersectionCount = count;
+
+        for (unsigned i = 3; i < tokens.size(); i++) {
+            if (tokens[i] == "highways") parsed.highways = true;
+            else if (tokens[i].compare(0, 6, "oneway") == 0) parsed.oneWayFraction = std::stod(tokens[i].substr(6)) / 100;
+            else if (tokens[i].compare(0, 4, "seed") == 0) parsed.seed = std::stoul(tokens[i].substr(4));
+            else return false;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    options = parsed;
+    return true;
+}
+
+std::string getSyntheticIntersectionName(const SyntheticMap& map, unsigned intersection) {
+    const std::pair<int, int>& streets = map.intersectionStreets[intersection];
+    return map.streetNames[streets.first] + " & " + map.streetNames[streets.second];
+}
@@ -0,0 +1,96 @@
+/* Synthetic road networks for benchmarking load_map, routing and drawing at any map size
+ * A map is generated from a layout (grid or radial city), a target intersection count, an optional overlay of
+ * highways and a fraction of one way streets. The same options and seed always generate the same map
+ * SyntheticDatabaseAPI.cpp serves the generated map through the StreetsDatabaseAPI and OSMDatabaseAPI functions,
+ * so the rest of the code loads it with load_map like any other map
+ */
+
+#ifndef SYNTHETICMAP_H
+#define SYNTHETICMAP_H
+
+#include "StreetsDatabaseAPI.h"
+
+#include <string>
+#include <vector>
+
+// Distance between neighbouring intersections in meters
+#define SYNTHETIC_BLOCK_LENGTH 100
+
+// Every SYNTHETIC_HIGHWAY_SPACING-th street is a highway when highways are enabled
+#define SYNTHETIC_HIGHWAY_SPACING 20
+
+// Speed limits in km/h
+#define SYNTHETIC_LOCAL_SPEED 50
+#define SYNTHETIC_HIGHWAY_SPEED 100
+
+// One POI per SYNTHETIC_POI_RATIO intersections, one feature per SYNTHETIC_FEATURE_RATIO intersections
+#define SYNTHETIC_POI_RATIO 20
+#define SYNTHETIC_FEATURE_RATIO 50
+
+enum SyntheticLayout {
+    GRID_LAYOUT = 0,
+    RADIAL_LAYOUT
+};
+
+struct SyntheticMapOptions {
+    SyntheticLayout layout = GRID_LAYOUT;
+
+    // Grids have exactly this many intersections, radial cities round up to full rings
+    unsigned intersectionCount = 10000;
+
+    // Turns every SYNTHETIC_HIGHWAY_SPACING-th street into a two way highway
+    bool highways = false;
+
+    // Fraction of the row (grid) or ring (radial) streets that are one way, the other streets stay two way
+    // so every intersection can still reach every other
+    double oneWayFraction = 0;
+
+    unsigned seed = 297;
+    LatLon origin = LatLon(43.65, -79.38);
+};
+
+struct SyntheticPOI {
+    LatLon position;
+    std::string name;
+    std::string type;
+};
+
+struct SyntheticFeature {
+    std::string name;
+    FeatureType type;
+    std::vector<LatLon> points;
+};
+
+/* Generated map in flat arrays, sized for millions of intersections
+ * Segments of intersection i are intersectionSegments[segmentOffsets[i], segmentOffsets[i + 1])
+ * Curve points of segment s are curvePoints[curvePointOffsets[s], curvePointOffsets[s + 1])
+ * Intersection names are built on request from the two streets that cross there
+ */
+struct SyntheticMap {
+    std::vector<LatLon> intersectionPositions;
+    std::vector<std::pair<int, int>> intersectionStreets;
+    std::vector<unsigned> segmentOffsets;
+    std::vector<int> intersectionSegments;
+
+    std::vector<InfoStreetSegment> segments;
+    std::vector<unsigned> curvePointOffsets;
+    std::vector<LatLon> curvePoints;
+
+    std::vector<std::string> streetNames;
+    std::vector<SyntheticPOI> pois;
+    std::vector<SyntheticFeature> features;
+};
+
+SyntheticMap generateSyntheticMap(const SyntheticMapOptions& options);
+
+/* Parses a map name of the form synthetic_<grid|radial>_<intersections>[_highways][_oneway<percent>][_seed<seed>]
+ * A directory before the name and a ".streets.bin" or ".osm.bin" suffix are ignored
+ * @params name, options to set
+ * @returns false if name is not a synthetic map name
+ */
+bool parseSyntheticMapName(std::string name, SyntheticMapOptions& options);
+
+// Name of the intersection, "<street> & <street>"
+std::string getSyntheticIntersectionName(const SyntheticMap& map, unsigned intersection);
+
+#endif /* SYNTHETICMAP_H */
@@ -0,0 +1,60 @@
+/* Unit tests of the route cache, its keys and its least recently used eviction
+ * They need no map, so they run without the map files
+ */
+#include <vector>
+#include <unittest++/UnitTest++.h>
+
+#include "RouteCache.h"
+
+SUITE(route_cache) {
+    TEST(hits_only_the_same_endpoints_and_penalties) {
+        RouteCache cache;
+        cache.setMap("map");
+        cache.insert(RouteKey{1, 2, 7, 13}, {10, 11, 12}, 42);
+
+        std::vector<unsigned> path;
+        double travelTime = 0;
+        CHECK(cache.find(RouteKey{1, 2, 7, 13}, path, travelTime));
+        CHECK(path == std::vector<unsigned>({10, 11, 12}));
+        CHECK_EQUAL(42, travelTime);
+
+        CHECK(!cache.find(RouteKey{2, 1, 7, 13}, path, travelTime));
+        CHECK(!cache.find(RouteKey{1, 2, 0, 0}, path, travelTime));
+        CHECK_EQUAL(1u, cache.getHitCount());
+        CHECK_EQUAL(2u, cache.getMissCount());
+    }
+
+    TEST(evicts_least_recently_used) {
+        RouteCache cache;
+        cache.setMap("map");
+        for (unsigned from = 0; from <= ROUTE_CACHE_CAPACITY; from++) {
+            cache.insert(RouteKey{from, from + 1, 0, 0}, {from}, from);
+
+            // Keeps the first path the most recently used
+            std::vector<unsigned> path;
+            double travelTime;
+            if (from > 0) CHECK(cache.find(RouteKey{0, 1, 0, 0}, path, travelTime));
+        }
+
+        std::vector<unsigned> path;
+        double travelTime;
+        CHECK_EQUAL((std::size_t)ROUTE_CACHE_CAPACITY, cache.size());
+        CHECK(cache.find(RouteKey{0, 1, 0, 0}, path, travelTime));
+        CHECK(!cache.find(RouteKey{1, 2, 0, 0}, path, travelTime));
+    }
+
+    TEST(another_map_drops_every_path) {
+        RouteCache cache;
+        cache.setMap("map");
+        cache.insert(RouteKey{1, 2, 0, 0}, {3}, 1);
+
+        cache.setMap("map");
+        CHECK_EQUAL(1u, cache.size());
+
+        cache.setMap("other map");
+        std::vector<unsigned> path;
+        double travelTime;
+        CHECK_EQUAL(0u, cache.size());
+        CHECK(!cache.find(RouteKey{1, 2, 0, 0}, path, travelTime));
+    }
+}
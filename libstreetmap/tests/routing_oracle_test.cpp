@@ -0,0 +1,287 @@
+/* Differential tests of the routing engines against the reference A* search in find_path_between_intersections
+ * Every engine registered here is run on the same seeded random queries, a failure prints the oracle summary
+ * with the smallest query that reproduces each mismatch
+ */
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_set>
+#include <unittest++/UnitTest++.h>
+
+#include "m1.h"
+#include "m3.h"
+#include "util.h"
+#include "RoutingOracle.h"
+#include "TurnGraph.h"
+#include "CellOverlay.h"
+#include "BatchRouting.h"
+#include "Isochrone.h"
+#include "FacilityIndex.h"
+
+#define ORACLE_TEST_MAP "toronto_canada"
+#define ORACLE_TEST_QUERIES 200
+#define ORACLE_TEST_SEED 297
+
+// The test map, loaded by the first test that needs it and closed once the tests exit
+struct OracleMap {
+    OracleMap() {
+        loaded = load_map(getMapPath(ORACLE_TEST_MAP));
+    }
+
+    ~OracleMap() {
+        if (loaded) close_map();
+    }
+
+    bool loaded;
+};
+
+static bool loadOracleMap() {
+    static OracleMap map;
+    return map.loaded;
+}
+
+// Every test of the suite shares one load of the map, tests must leave it as they found it
+// A map that fails to load fails each test from here, UnitTest++ reports the exception and skips the test body
+struct OracleMapFixture {
+    OracleMapFixture() {
+        if (!loadOracleMap()) throw std::runtime_error("could not load " ORACLE_TEST_MAP);
+    }
+};
+
+// Path to a single destination through the one-to-many search
+static std::vector<unsigned> findPathThroughMultiSearch(unsigned from, unsigned to, double rightTurnPenalty, double leftTurnPenalty) {
+    std::unordered_set<unsigned> destinations = {to};
+    auto paths = find_paths_to_destinations(from, destinations, rightTurnPenalty, leftTurnPenalty);
+
+    auto path = paths.find(to);
+    return path == paths.end() ? std::vector<unsigned>() : path->second.second;
+}
+
+static void printMismatches(RoutingOracle& oracle) {
+    if (!oracle.getMismatches().empty()) std::cerr << oracle.getSummary();
+}
+
+SUITE(routing_oracle) {
+    TEST_FIXTURE(OracleMapFixture, reference_is_legal_and_deterministic) {
+        RoutingOracle oracle("reference", find_path_between_intersections);
+        oracle.checkAll(generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY));
+
+        printMismatches(oracle);
+        CHECK_EQUAL(0u, oracle.getMismatches().size());
+    }
+
+    TEST_FIXTURE(OracleMapFixture, multi_destination_search_matches_reference_without_penalties) {
+        RoutingOracle oracle("find_paths_to_destinations", findPathThroughMultiSearch);
+        oracle.checkAll(generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED, 0, 0));
+
+        printMismatches(oracle);
+        CHECK_EQUAL(0u, oracle.getMismatches().size());
+    }
+
+    TEST_FIXTURE(OracleMapFixture, multi_destination_paths_are_legal_with_penalties) {
+        std::vector<OracleQuery> queries = generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        for (auto query = queries.begin(); query != queries.end(); query++) {
+            std::vector<unsigned> path = findPathThroughMultiSearch(query->from, query->to, query->rightTurnPenalty, query->leftTurnPenalty);
+            if (!path.empty()) CHECK_EQUAL("", getPathError(path, query->from, query->to));
+        }
+    }
+
+    TEST_FIXTURE(OracleMapFixture, turn_exact_search_matches_reference_without_penalties) {
+        RoutingOracle oracle("findTurnExactPath", findTurnExactPath);
+        oracle.checkAll(generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED, 0, 0));
+
+        printMismatches(oracle);
+        CHECK_EQUAL(0u, oracle.getMismatches().size());
+    }
+
+    // The reference keeps one best time per intersection, so with penalties it can miss the cheapest path
+    TEST_FIXTURE(OracleMapFixture, turn_exact_search_is_never_costlier_than_reference) {
+        RoutingOracle oracle("findTurnExactPath", findTurnExactPath);
+        oracle.setAllowCheaper(true);
+        oracle.checkAll(generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY));
+
+        printMismatches(oracle);
+        CHECK_EQUAL(0u, oracle.getMismatches().size());
+    }
+
+    // Both are exact with penalties, so they must agree for every penalty pair, including after switching pairs
+    TEST_FIXTURE(OracleMapFixture, overlay_search_matches_turn_exact_search) {
+        RoutingOracle oracle("findOverlayPath", findOverlayPath);
+        oracle.setReference(findTurnExactPath);
+        oracle.checkAll(generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY));
+        oracle.checkAll(generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED + 1, 0, 0));
+        oracle.checkAll(generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED + 2, 2 * store.RIGHT_TURN_PENALTY, 3 * store.LEFT_TURN_PENALTY));
+
+        printMismatches(oracle);
+        CHECK_EQUAL(0u, oracle.getMismatches().size());
+    }
+
+    // Penalty pairs are interleaved, so the batch reorders them internally and must still answer in request order
+    TEST_FIXTURE(OracleMapFixture, batch_matches_single_queries_in_order) {
+        std::vector<OracleQuery> withPenalties = generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        std::vector<OracleQuery> withoutPenalties = generateOracleQueries(ORACLE_TEST_QUERIES, ORACLE_TEST_SEED + 1, 0, 0);
+
+        std::vector<RouteRequest> requests;
+        for (unsigned query = 0; query < withPenalties.size() && query < withoutPenalties.size(); query++) {
+            for (const OracleQuery* oracleQuery : {&withPenalties[query], &withoutPenalties[query]}) {
+                requests.push_back(RouteRequest{oracleQuery->from, oracleQuery->to, oracleQuery->rightTurnPenalty, oracleQuery->leftTurnPenalty});
+            }
+        }
+        requests.push_back(RouteRequest{requests.front().from, requests.front().from, 0, 0});
+
+        std::vector<RouteResult> results = findPathsInBatch(requests, 4);
+        CHECK_EQUAL(requests.size(), results.size());
+        if (results.size() != requests.size()) return;
+
+        for (unsigned request = 0; request < requests.size(); request++) {
+            const RouteRequest& query = requests[request];
+            std::vector<unsigned> path = findTurnExactPath(query.from, query.to, query.rightTurnPenalty, query.leftTurnPenalty);
+
+            CHECK(path == results[request].path);
+            if (query.from == query.to) CHECK_EQUAL(0, results[request].travelTime);
+            else CHECK_CLOSE(compute_path_travel_time(path, query.rightTurnPenalty, query.leftTurnPenalty), results[request].travelTime, 1e-9);
+        }
+    }
+
+    TEST_FIXTURE(OracleMapFixture, travel_times_match_turn_exact_paths) {
+        // Every query is a full sweep, so only a few sources are checked
+        std::vector<OracleQuery> queries = generateOracleQueries(20, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        for (const OracleQuery& query : queries) {
+            std::vector<double> times = findTravelTimesFrom(query.from, query.rightTurnPenalty, query.leftTurnPenalty);
+            std::vector<unsigned> path = findTurnExactPath(query.from, query.to, query.rightTurnPenalty, query.leftTurnPenalty);
+
+            CHECK_EQUAL(0, times[query.from]);
+            if (query.from == query.to) continue;
+            if (path.empty()) CHECK_EQUAL(DBL_MAX, times[query.to]);
+            else CHECK_CLOSE(compute_path_travel_time(path, query.rightTurnPenalty, query.leftTurnPenalty), times[query.to], 1e-6);
+        }
+    }
+
+    TEST_FIXTURE(OracleMapFixture, isochrone_holds_everything_within_the_limit) {
+        unsigned source = generateOracleQueries(1, ORACLE_TEST_SEED, 0, 0).front().from;
+        double timeLimit = 600;
+        std::vector<double> times = findTravelTimesFrom(source, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        Isochrone isochrone = findIsochrone(source, timeLimit, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+
+        unsigned inReach = 0;
+        for (double time : times) if (time <= timeLimit) inReach++;
+        CHECK_EQUAL(inReach, isochrone.intersections.size());
+        CHECK_EQUAL(source, isochrone.intersections.front());
+
+        for (unsigned index = 0; index < isochrone.intersections.size(); index++) {
+            CHECK_EQUAL(times[isochrone.intersections[index]], isochrone.intersectionTimes[index]);
+        }
+        for (unsigned index = 0; index < isochrone.segments.size(); index++) {
+            CHECK(isochrone.segmentTimes[index] <= timeLimit);
+        }
+    }
+
+    // The early stopping search must return the first k POIs of a type in the order of a full sweep's travel times
+    TEST_FIXTURE(OracleMapFixture, nearest_facilities_match_a_full_sweep) {
+        std::vector<OracleQuery> queries = generateOracleQueries(10, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        for (unsigned query = 0; query < queries.size(); query++) {
+            unsigned source = queries[query].from;
+            std::string type = store.facilityIndex.getCategoryName(query % store.facilityIndex.getCategoryCount());
+            std::vector<double> times = findTravelTimesFrom(source, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+
+            std::vector<std::pair<double, unsigned>> expected;
+            for (int poi = 0; poi < getNumPointsOfInterest(); poi++) {
+                double time = times[store.facilityIndex.getSnappedIntersection(poi)];
+                if (getPointOfInterestType(poi) == type && time != DBL_MAX) expected.push_back(std::make_pair(time, poi));
+            }
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<FacilityMatch> matches = findNearestFacilities(source, type, FACILITY_DEFAULT_RESULTS, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+            CHECK_EQUAL(std::min<std::size_t>(FACILITY_DEFAULT_RESULTS, expected.size()), matches.size());
+            for (unsigned match = 0; match < matches.size() && match < expected.size(); match++) {
+                CHECK_CLOSE(expected[match].first, matches[match].travelTime, 1e-6);
+                if (!matches[match].path.empty()) {
+                    CHECK_EQUAL("", getPathError(matches[match].path, source, matches[match].intersection));
+                }
+            }
+        }
+
+        CHECK(findNearestFacilities(0, "no such type", FACILITY_DEFAULT_RESULTS, 0, 0).empty());
+    }
+
+    TEST_FIXTURE(OracleMapFixture, overlay_metrics_are_cached_per_penalty_pair) {
+        std::shared_ptr<const OverlayMetric> metric = store.cellOverlay.getMetric(store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        store.cellOverlay.getMetric(0, 0);
+        CHECK(metric == store.cellOverlay.getMetric(store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY));
+        CHECK(metric != store.cellOverlay.getMetric(0, 0));
+    }
+
+    TEST_FIXTURE(OracleMapFixture, oracle_reports_illegal_paths) {
+        // Drops the last segment, so the path ends one intersection early
+        auto truncated = [](unsigned from, unsigned to, double right, double left) {
+            std::vector<unsigned> path = find_path_between_intersections(from, to, right, left);
+            if (!path.empty()) path.pop_back();
+            return path;
+        };
+
+        RoutingOracle oracle("truncated", truncated);
+        std::vector<OracleQuery> queries = generateOracleQueries(20, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        oracle.checkAll(queries);
+
+        std::vector<OracleMismatch> mismatches = oracle.getMismatches();
+        CHECK(!mismatches.empty());
+
+        // The shrunk query still fails, on a path no longer than the original
+        for (auto mismatch = mismatches.begin(); mismatch != mismatches.end() && mismatch - mismatches.begin() < ORACLE_MINIMIZED_MISMATCHES; mismatch++) {
+            CHECK(mismatch->type == ILLEGAL_PATH || mismatch->type == REACHABILITY_MISMATCH);
+            CHECK_EQUAL(0.0, mismatch->minimalQuery.rightTurnPenalty);
+
+            OracleQuery minimal = mismatch->minimalQuery;
+            std::vector<unsigned> original = find_path_between_intersections(mismatch->query.from, mismatch->query.to, 0, 0);
+            std::vector<unsigned> shrunk = find_path_between_intersections(minimal.from, minimal.to, 0, 0);
+            CHECK(shrunk.size() <= original.size());
+            CHECK(!oracle.check(minimal));
+        }
+    }
+
+    TEST_FIXTURE(OracleMapFixture, oracle_reports_illegal_reference_paths) {
+        auto truncated = [](unsigned from, unsigned to, double right, double left) {
+            std::vector<unsigned> path = find_path_between_intersections(from, to, right, left);
+            if (!path.empty()) path.pop_back();
+            return path;
+        };
+
+        // A correct engine against a broken reference
+        RoutingOracle oracle("reference", find_path_between_intersections);
+        oracle.setReference(truncated);
+        std::vector<OracleQuery> queries = generateOracleQueries(20, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        oracle.checkAll(queries);
+
+        std::vector<OracleMismatch> mismatches = oracle.getMismatches();
+        CHECK(!mismatches.empty());
+        for (auto mismatch = mismatches.begin(); mismatch != mismatches.end(); mismatch++) {
+            CHECK(mismatch->type == ILLEGAL_REFERENCE_PATH || mismatch->type == REACHABILITY_MISMATCH);
+        }
+    }
+
+    TEST_FIXTURE(OracleMapFixture, oracle_reports_costlier_paths) {
+        // Legal detour, goes down a two way segment at the destination and comes back
+        auto detour = [](unsigned from, unsigned to, double right, double left) {
+            std::vector<unsigned> path = find_path_between_intersections(from, to, right, left);
+            std::vector<unsigned> segments = find_intersection_street_segments(to);
+            for (auto segment = segments.begin(); segment != segments.end() && !path.empty(); segment++) {
+                if (getInfoStreetSegment(*segment).oneWay) continue;
+                path.push_back(*segment);
+                path.push_back(*segment);
+                break;
+            }
+            return path;
+        };
+
+        RoutingOracle oracle("detour", detour);
+        std::vector<OracleQuery> queries = generateOracleQueries(20, ORACLE_TEST_SEED, store.RIGHT_TURN_PENALTY, store.LEFT_TURN_PENALTY);
+        oracle.checkAll(queries);
+
+        std::vector<OracleMismatch> mismatches = oracle.getMismatches();
+        CHECK(!mismatches.empty());
+        for (auto mismatch = mismatches.begin(); mismatch != mismatches.end(); mismatch++) {
+            CHECK_EQUAL(COST_MISMATCH, mismatch->type);
+            CHECK(mismatch->engineCost > mismatch->referenceCost);
+        }
+    }
+}
@@ -27,31 +27,41 @@
 #include "m3.h"
 #include "util.h"
 #include "Store.h"
+#include "RefreshCallbacks.h"
 
 //Program exit codes
 constexpr int SUCCESS_EXIT_CODE = 0;        //Everything went OK
 constexpr int ERROR_EXIT_CODE = 1;          //An error occurred
 constexpr int BAD_ARGUMENTS_EXIT_CODE = 2;  //Invalid command-line usage
 
-int main() {
+int renderHeadless(int argc, char** argv);
+int reportLoad(int argc, char** argv);
+
+int main(int argc, char** argv) {
+    
+    // Batch render mode, no GTK window is created
+    if (argc > 1 && std::string(argv[1]) == "--render") return renderHeadless(argc, argv);
+    
+    // Load timing report, no GTK window is created
+    if (argc > 1 && std::string(argv[1]) == "--load-report") return reportLoad(argc, argv);
 
     do {
             
         curl_global_init(CURL_GLOBAL_ALL);
         store.reloadFlag = false;
-        std::string map_path = "/cad2/ece297s/public/maps/" + store.mapName + ".streets.bin";
+        std::string map_path = getMapPath(store.mapName);
 
         // Load the map and related data structures
         bool load_success = load_map(map_path);
         if(!load_success) {
             store.mapName = store.prevMap;
-            map_path = "/cad2/ece297s/public/maps/" + store.mapName + ".streets.bin";
+            map_path = getMapPath(store.mapName);
             std::cerr << "Failed to load map '" << map_path << "'\n";
             std::cout << "Restarting with previous map " << store.mapName << "\n";
             load_map(map_path);
         }
 
-        std::cout << "Successfully loaded map '" << map_path << "'\n";
+        std::cout << "Successfully loaded map '" << map_path << "' in " << store.loadReport.getTotalTime() << "ms\n";
 
         store.loadSuccessFlag = load_success;
         
@@ -69,3 +79,129 @@ int main() {
 
     return SUCCESS_EXIT_CODE;
 }
+
+/* Headless batch render, renders a map view to a PNG and reports the frame times
+ * Usage: mapper --render <map_name> <output.png> [zoom_level] [frames]
+ * The view is centered on the map, and rendered frames times to benchmark the render
+ */
+int renderHeadless(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --render <map_name> <output.png> [zoom_level] [frames]\n";
+        return BAD_ARGUMENTS_EXIT_CODE;
+    }
+    
+    std::string map_path = getMapPath(argv[2]);
+    std::string png_path = argv[3];
+    int zoomLevel = 1, frames = 1;
+    
+    try {
+        if (argc > 4) zoomLevel = std::stoi(argv[4]);
+        if (argc > 5) frames = std::stoi(argv[5]);
+    } catch (const std::exception&) {
+        std::cerr << "Zoom level and frames must be whole numbers\n";
+        return BAD_ARGUMENTS_EXIT_CODE;
+    }
+    
+    if (zoomLevel < 1 || zoomLevel > 11 || frames < 1) {
+        std::cerr << "Zoom level must be between 1 and 11, and frames at least 1\n";
+        return BAD_ARGUMENTS_EXIT_CODE;
+    }
+    
+    curl_global_init(CURL_GLOBAL_ALL);
+    store.mapName = argv[2];
+    
+    if (!load_map(map_path)) {
+        std::cerr << "Failed to load map '" << map_path << "'\n";
+        curl_global_cleanup();
+        return ERROR_EXIT_CODE;
+    }
+    
+    ezgl::rectangle world = getZoomedWorld(store.WORLD_BOUNDS, store.WORLD_BOUNDS.center(), zoomLevel);
+    
+    // Each frame is timed by the render profiler
+    store.profilingFlag = true;
+    store.renderProfiler.reset();
+    
+    bool success = true;
+    for (int frame = 0; frame < frames && success; frame++) {
+        success = render_map_to_png(png_path, world, zoomLevel, 1280, 720);
+    }
+    
+    if (success) {
+        std::cout << "Rendered '" << png_path << "' " << store.renderProfiler.getSummary() << "\n";
+    } else {
+        std::cerr << "Failed to write '" << png_path << "'\n";
+    }
+    
+    close_map();
+    curl_global_cleanup();
+    
+    return success ? SUCCESS_EXIT_CODE : ERROR_EXIT_CODE;
+}
+
+/* Loads a map once and reports the time of each load phase and the size of each Store container
+ * Usage: mapper --load-report <map_name> [report.json] [budget_ms | phase=budget_ms ...]
+ * Budgets and the report path may come in any order, an argument that is not a budget is the report path
+ * A plain budget applies to every phase without its own budget, fails if any phase is over its budget
+ */
+int reportLoad(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --load-report <map_name> [report.json] [budget_ms | phase=budget_ms ...]\n";
+        return BAD_ARGUMENTS_EXIT_CODE;
+    }
+    
+    std::string map_path = getMapPath(argv[2]);
+    std::string json_path;
+    
+    // Whole argument in ms, so a path like 500.json is not read as a budget
+    auto parseBudget = [](const std::string& text, double& budget) {
+        try {
+            std::size_t used = 0;
+            budget = std::stod(text, &used);
+            return used == text.size();
+        } catch (const std::exception&) {
+            return false;
+        }
+    };
+    
+    for (int arg = 3; arg < argc; arg++) {
+        std::string argument = argv[arg];
+        std::size_t split = argument.rfind('=');
+        double budget;
+        
+        if (parseBudget(argument, budget)) {
+            store.loadReport.setDefaultBudget(budget);
+        } else if (split != std::string::npos && parseBudget(argument.substr(split + 1), budget)) {
+            store.loadReport.setBudget(argument.substr(0, split), budget);
+        } else if (json_path.empty()) {
+            json_path = argument;
+        } else {
+            std::cerr << "Budgets must be in ms, either for every phase or as phase=budget_ms, and there is one report path\n";
+            return BAD_ARGUMENTS_EXIT_CODE;
+        }
+    }
+    
+    curl_global_init(CURL_GLOBAL_ALL);
+    store.mapName = argv[2];
+    
+    bool loaded = load_map(map_path);
+    bool success = loaded;
+    if (!loaded) std::cerr << "Failed to load map '" << map_path << "'\n";
+    
+    std::cout << store.loadReport.getSummary();
+    
+    if (!json_path.empty() && !store.loadReport.writeJSON(json_path)) {
+        std::cerr << "Failed to write '" << json_path << "'\n";
+        success = false;
+    }
+    
+    std::vector<std::string> overBudget = store.loadReport.getOverBudget();
+    for (auto phase = overBudget.begin(); phase != overBudget.end(); phase++) {
+        std::cerr << "Load phase '" << *phase << "' is over budget\n";
+    }
+    
+    if (loaded) close_map();
+    curl_global_cleanup();
+    
+    return success && overBudget.empty() ? SUCCESS_EXIT_CODE : ERROR_EXIT_CODE;
+}